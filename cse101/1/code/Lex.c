@@ -11,88 +11,736 @@
  * 
  */
 #include "List.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <unistd.h>
 
-extern char* strdup(const char*);
+// One line of the input, viewed in place inside the input buffer. The
+// trailing newline is not part of the view. key caches the first 8 bytes
+// big-endian and zero padded, so most comparisons never touch str.
+typedef struct LineObj {
+  const char *str;
+  size_t len;
+  uint64_t key;
+} Line;
 
-int main(int argc, char **argv) {
-  if(argc != 3) {
-    fprintf(stderr, "correct format is: Lex <input file> <output file>\n");
+// Loads 8 bytes of s (of which len are left) as a big-endian integer,
+// padding with zeros past the end.
+static uint64_t loadKey(const char *s, size_t len) {
+  uint64_t k = 0;
+  if(len >= 8) {
+    memcpy(&k, s, 8);
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    k = __builtin_bswap64(k);
+#endif
+    return k;
+  }
+  for(size_t i = 0; i < 8; i++) {
+    k = (k << 8) | (i < len ? (unsigned char)s[i] : 0);
+  }
+  return k;
+}
+
+static void makeLine(Line *l, const char *s, size_t len) {
+  l->str = s;
+  l->len = len;
+  l->key = loadKey(s, len);
+}
+
+// Whole input file in memory: mmap'ed when it is a regular file, read into
+// a heap buffer otherwise (pipes, character devices) or when copy is set. The
+// output may be the input file itself; writing it truncates the file under a
+// live mapping, so that case has to take a private copy.
+typedef struct InputObj {
+  char *base;
+  size_t size;
+  int mapped;
+} Input;
+
+static void openInput(Input *in, const char *path, int copy) {
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) {
+    fprintf(stderr, "faile to open file %s\n", path);
     exit(1);
   }
-  FILE *in = fopen(argv[1], "r");
-  if(in == NULL) {
-    fprintf(stderr, "faile to open file %s\n", argv[1]);
+  struct stat st;
+  if(fstat(fd, &st) < 0) {
+    fprintf(stderr, "failed to stat file %s\n", path);
     exit(1);
   }
-  int line = 0; 
-  char buff[1024] = {0};
-  while(!feof(in)) {
-    fgets(buff, 1024, in);
-    if(!strlen(buff)) break;
-    if(buff[strlen(buff) - 1] == '\n') buff[strlen(buff) - 1] = 0;
-    // printf("read: %s\n", buff);
-    line+=1;
-    memset(buff, 0, sizeof(buff));
+  in->base = NULL;
+  in->size = 0;
+  in->mapped = 0;
+  if(S_ISREG(st.st_mode) && !copy) {
+    in->size = (size_t)st.st_size;
+    if(in->size == 0) {
+      close(fd);
+      return;
+    }
+    void *p = mmap(NULL, in->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if(p != MAP_FAILED) {
+      in->base = (char*)p;
+      in->mapped = 1;
+      close(fd);
+      return;
+    }
+    in->size = 0;
   }
-  // printf("line: %d\n", line);
+  size_t cap = 1 << 16;
+  in->base = (char*)malloc(cap);
+  ssize_t n;
+  while((n = read(fd, in->base + in->size, cap - in->size)) > 0) {
+    in->size += (size_t)n;
+    if(in->size == cap) {
+      cap *= 2;
+      in->base = (char*)realloc(in->base, cap);
+    }
+  }
+  if(n < 0) {
+    fprintf(stderr, "failed to read file %s\n", path);
+    exit(1);
+  }
+  close(fd);
+}
 
-  char **words = (char**)calloc(1, sizeof(char*) * line);
-  for(int i = 0; i < line; i++) {
-    words[i] = NULL;
+static void closeInput(Input *in) {
+  if(in->mapped) {
+    munmap(in->base, in->size);
+  } else {
+    free(in->base);
   }
+  in->base = NULL;
+  in->size = 0;
+}
 
-  fseek(in, 0, SEEK_SET);
+// Cuts the buffer into lines in a single pass. A final line without a
+// newline still counts; a trailing newline does not start an empty line.
+static Line *splitLines(const char *buf, size_t size, int *pCnt) {
+  int cnt = 0, cap = 1024;
+  Line *lines = (Line*)malloc(sizeof(Line) * cap);
+  const char *cur = buf, *end = buf + size;
+  while(cur < end) {
+    const char *nl = memchr(cur, '\n', (size_t)(end - cur));
+    size_t len = (nl == NULL) ? (size_t)(end - cur) : (size_t)(nl - cur);
+    if(cnt == cap) {
+      cap *= 2;
+      lines = (Line*)realloc(lines, sizeof(Line) * cap);
+    }
+    makeLine(&lines[cnt++], cur, len);
+    cur += len + 1;
+  }
+  *pCnt = cnt;
+  return lines;
+}
 
-  int idx = 0;
-  while(!feof(in)) {
-    fgets(buff, 1024, in);
-    if(!strlen(buff)) break;
-    if(buff[strlen(buff) - 1] == '\n') buff[strlen(buff) - 1] = 0;
-    words[idx++] = strdup(buff);
-    memset(buff, 0, sizeof(buff));
+// Byte-wise order, a proper prefix sorts first (same as strcmp on the text).
+// Equal keys with a line of at most 8 bytes mean that line is a prefix of
+// the other one.
+static int compareLine(const Line *a, const Line *b) {
+  if(a->key != b->key) return a->key < b->key ? -1 : 1;
+  size_t n = a->len < b->len ? a->len : b->len;
+  if(n > 8) {
+    int c = memcmp(a->str + 8, b->str + 8, n - 8);
+    if(c != 0) return c;
   }
-  
-  List list = newList();
-  for(int i = 0; i < line; i++) {
-    moveFront(list);
-    if(index(list) < 0) {
-      append(list, i);
-      continue;
+  return (a->len > b->len) - (a->len < b->len);
+}
+
+// Stable merge sort of the line indices in idx[0..n) by compareLine order.
+// Equal lines keep their input order, same as the old insertion sort.
+// tmp is scratch space of at least n ints.
+static void mergeSort(const Line *lines, int *idx, int *tmp, int n) {
+  if(n < 2) return;
+  int mid = n / 2;
+  mergeSort(lines, idx, tmp, mid);
+  mergeSort(lines, idx + mid, tmp, n - mid);
+  if(compareLine(&lines[idx[mid - 1]], &lines[idx[mid]]) <= 0) return;
+  int i = 0, j = mid, k = 0;
+  while(i < mid && j < n) {
+    if(compareLine(&lines[idx[j]], &lines[idx[i]]) < 0) {
+      tmp[k++] = idx[j++];
+    } else {
+      tmp[k++] = idx[i++];
+    }
+  }
+  while(i < mid) {
+    tmp[k++] = idx[i++];
+  }
+  // whatever is left of the right half is already in place
+  memcpy(idx, tmp, sizeof(int) * k);
+}
+
+// String sort -----------------------------------------------------------------
+// MSD radix sort on cached keys. A pass loads the 8 bytes at the current depth
+// of every line into an array next to its index, sorts that array with a
+// stable LSD radix sort on the key, and then handles each run of equal keys:
+// lines that end inside the run are done and only ordered by length, the
+// rest is sorted again at depth + 8. A long shared prefix costs one load per
+// line per 8 bytes instead of a strcmp over it on every comparison.
+
+#define RADIX_MIN 64
+#define MSD_MAX_DEPTH 4096
+
+typedef struct KeyEntryObj {
+  uint64_t key;
+  int idx;
+} KeyEntry;
+
+static void keyInsertionSort(KeyEntry *e, int n) {
+  for(int i = 1; i < n; i++) {
+    KeyEntry x = e[i];
+    int j = i;
+    while(j > 0 && e[j - 1].key > x.key) {
+      e[j] = e[j - 1];
+      j--;
+    }
+    e[j] = x;
+  }
+}
+
+// Stable LSD radix sort of e[0..n) by key, one byte per pass. Bytes that are
+// the same in every key are skipped.
+static void keyRadixSort(KeyEntry *e, KeyEntry *tmp, int n) {
+  int cnt[8][256];
+  memset(cnt, 0, sizeof(cnt));
+  for(int i = 0; i < n; i++) {
+    uint64_t k = e[i].key;
+    for(int b = 0; b < 8; b++) {
+      cnt[b][(k >> (8 * b)) & 0xff]++;
+    }
+  }
+  KeyEntry *src = e, *dst = tmp;
+  for(int b = 0; b < 8; b++) {
+    int *c = cnt[b];
+    if(c[(src[0].key >> (8 * b)) & 0xff] == n) continue;
+    int sum = 0;
+    for(int v = 0; v < 256; v++) {
+      int t = c[v];
+      c[v] = sum;
+      sum += t;
     }
-    while(index(list) >= 0) {
-      int idx = get(list);
-      if(strcmp(words[idx], words[i]) > 0) break;
-      moveNext(list);
+    for(int i = 0; i < n; i++) {
+      dst[c[(src[i].key >> (8 * b)) & 0xff]++] = src[i];
     }
-    if(index(list) < 0) {
-      append(list, i);
+    KeyEntry *swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if(src != e) memcpy(e, src, sizeof(KeyEntry) * n);
+}
+
+// Sorts idx[0..n), whose lines all agree on their first depth bytes. e and
+// tmp are scratch space of at least n entries.
+static void msdSort(const Line *lines, int *idx, KeyEntry *e, KeyEntry *tmp, int n, size_t depth) {
+  if(depth >= MSD_MAX_DEPTH) {
+    // pathological shared prefix, stop recursing and compare whole lines
+    mergeSort(lines, idx, (int*)tmp, n);
+    return;
+  }
+  for(int i = 0; i < n; i++) {
+    const Line *l = &lines[idx[i]];
+    if(depth == 0) {
+      e[i].key = l->key;
+    } else {
+      e[i].key = (l->len > depth) ? loadKey(l->str + depth, l->len - depth) : 0;
+    }
+    e[i].idx = idx[i];
+  }
+  if(n < RADIX_MIN) {
+    keyInsertionSort(e, n);
+  } else {
+    keyRadixSort(e, tmp, n);
+  }
+  for(int i = 0; i < n; i++) {
+    idx[i] = e[i].idx;
+  }
+
+  int i = 0;
+  while(i < n) {
+    int j = i + 1;
+    while(j < n && e[j].key == e[i].key) j++;
+    if(j - i > 1) {
+      // finished lines stay in idx, the others are parked in e[i..i+u)
+      int f = i, u = 0;
+      for(int k = i; k < j; k++) {
+        if(lines[idx[k]].len <= depth + 8) {
+          idx[f++] = idx[k];
+        } else {
+          e[i + u++].idx = idx[k];
+        }
+      }
+      for(int k = 0; k < u; k++) {
+        idx[f + k] = e[i + k].idx;
+      }
+      for(int a = i + 1; a < f; a++) {
+        int x = idx[a], b = a;
+        while(b > i && lines[idx[b - 1]].len > lines[x].len) {
+          idx[b] = idx[b - 1];
+          b--;
+        }
+        idx[b] = x;
+      }
+      if(u > 1) msdSort(lines, idx + f, e + i, tmp + i, u, depth + 8);
+    }
+    i = j;
+  }
+}
+
+static void stringSort(const Line *lines, int *idx, int n) {
+  KeyEntry *e = (KeyEntry*)malloc(sizeof(KeyEntry) * (n + 1));
+  KeyEntry *tmp = (KeyEntry*)malloc(sizeof(KeyEntry) * (n + 1));
+  msdSort(lines, idx, e, tmp, n, 0);
+  free(e);
+  free(tmp);
+}
+
+// Parallel sort ---------------------------------------------------------------
+// The index array is cut into one chunk per thread and every chunk is string
+// sorted on its own thread. Chunks are then merged pairwise, level by level,
+// ping-ponging between order and tmp. Every level keeps all threads busy: a
+// merge is cut into equal output slices whose split points come from a
+// binary search along the merge path. Ties always go to the left run, so
+// the result is the same as the sequential merge sort.
+
+#define MIN_CHUNK (1 << 14)
+
+typedef struct SortTaskObj {
+  const Line *lines;
+  int *idx;           // chunk sort: sort idx[0..n)
+  int n;
+  const int *a, *b;   // slice merge: out[k0..k1) of merging a[0..na), b[0..nb)
+  int na, nb;
+  int *out;
+  int k0, k1;
+} SortTask;
+
+static void *sortChunk(void *arg) {
+  SortTask *t = (SortTask*)arg;
+  stringSort(t->lines, t->idx, t->n);
+  return NULL;
+}
+
+// Number of elements of a among the first k elements of merge(a, b).
+static int coRank(const Line *lines, const int *a, int na, const int *b, int nb, int k) {
+  int lo = k > nb ? k - nb : 0, hi = k < na ? k : na;
+  while(lo < hi) {
+    int i = lo + (hi - lo) / 2, j = k - i;
+    if(compareLine(&lines[a[i]], &lines[b[j - 1]]) <= 0) {
+      lo = i + 1;
+    } else {
+      hi = i;
+    }
+  }
+  return lo;
+}
+
+static void *mergeSlice(void *arg) {
+  SortTask *t = (SortTask*)arg;
+  int i = coRank(t->lines, t->a, t->na, t->b, t->nb, t->k0), j = t->k0 - i;
+  int ie = coRank(t->lines, t->a, t->na, t->b, t->nb, t->k1), je = t->k1 - ie;
+  int k = t->k0;
+  while(i < ie && j < je) {
+    if(compareLine(&t->lines[t->b[j]], &t->lines[t->a[i]]) < 0) {
+      t->out[k++] = t->b[j++];
     } else {
-      insertBefore(list, i);
+      t->out[k++] = t->a[i++];
+    }
+  }
+  while(i < ie) {
+    t->out[k++] = t->a[i++];
+  }
+  while(j < je) {
+    t->out[k++] = t->b[j++];
+  }
+  return NULL;
+}
+
+static void runTasks(SortTask *task, int n, void *(*fn)(void*)) {
+  pthread_t *tid = (pthread_t*)calloc(1, sizeof(pthread_t) * n);
+  for(int i = 0; i < n; i++) {
+    if(pthread_create(&tid[i], NULL, fn, &task[i]) != 0) {
+      fprintf(stderr, "failed to create sort thread\n");
+      exit(1);
     }
   }
+  for(int i = 0; i < n; i++) {
+    pthread_join(tid[i], NULL);
+  }
+  free(tid);
+}
+
+static void parallelSort(const Line *lines, int *order, int *tmp, int n, int threads) {
+  SortTask *task = (SortTask*)calloc(1, sizeof(SortTask) * threads);
+  int *bound = (int*)calloc(1, sizeof(int) * (threads + 1));
+  for(int i = 0; i <= threads; i++) {
+    bound[i] = (int)((long long)n * i / threads);
+  }
+  for(int i = 0; i < threads; i++) {
+    task[i].lines = lines;
+    task[i].idx = order + bound[i];
+    task[i].n = bound[i + 1] - bound[i];
+  }
+  runTasks(task, threads, sortChunk);
 
-  FILE *out = fopen(argv[2], "w");
+  int *src = order, *dst = tmp;
+  for(int width = 1; width < threads; width *= 2) {
+    int merges = 0;
+    for(int i = 0; i + width < threads; i += 2 * width) merges++;
+    int pieces = threads / merges;
+    int m = 0;
+    for(int i = 0; i < threads; i += 2 * width) {
+      int lo = bound[i];
+      if(i + width >= threads) {
+        // odd run out at this level, carry it over
+        memcpy(dst + lo, src + lo, sizeof(int) * (n - lo));
+        break;
+      }
+      int mid = bound[i + width];
+      int hi = bound[(i + 2 * width < threads) ? i + 2 * width : threads];
+      for(int p = 0; p < pieces; p++) {
+        SortTask *t = &task[m++];
+        t->lines = lines;
+        t->a = src + lo;
+        t->na = mid - lo;
+        t->b = src + mid;
+        t->nb = hi - mid;
+        t->out = dst + lo;
+        t->k0 = (int)((long long)(hi - lo) * p / pieces);
+        t->k1 = (int)((long long)(hi - lo) * (p + 1) / pieces);
+      }
+    }
+    runTasks(task, m, mergeSlice);
+    int *swap = src;
+    src = dst;
+    dst = swap;
+  }
+  if(src != order) memcpy(order, src, sizeof(int) * n);
+  free(task);
+  free(bound);
+}
+
+// Fills order[0..n) with the line indices in sorted order, using up to
+// threads threads.
+static void sortLines(const Line *lines, int *order, int n, int threads) {
+  for(int i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  if(threads > n / MIN_CHUNK) threads = n / MIN_CHUNK;
+  if(threads > 1) {
+    int *tmp = (int*)calloc(1, sizeof(int) * (n + 1));
+    parallelSort(lines, order, tmp, n, threads);
+    free(tmp);
+  } else {
+    stringSort(lines, order, n);
+  }
+}
+
+// The output is only opened once the whole input has been read, so a
+// missing input leaves it alone and Lex f f sorts f in place.
+static FILE *openOutput(const char *path) {
+  FILE *out = fopen(path, "w");
   if(out == NULL) {
-    fprintf(stderr, "failed to open file %s\n", argv[2]);
+    fprintf(stderr, "failed to open file %s\n", path);
     exit(1);
   }
+  return out;
+}
+
+static void writeLine(FILE *out, const Line *l) {
+  fwrite(l->str, 1, l->len, out);
+  fputc('\n', out);
+}
+
+static void sortInMemory(const char *path, const char *outPath, int threads, int copy) {
+  Input in;
+  openInput(&in, path, copy);
+  int line = 0;
+  Line *lines = splitLines(in.base, in.size, &line);
+
+  // sort line indices in O(n log n), then append them in order
+  int *order = (int*)calloc(1, sizeof(int) * (line + 1));
+  sortLines(lines, order, line, threads);
+  List list = newList();
+  for(int i = 0; i < line; i++) {
+    append(list, order[i]);
+  }
+  free(order);
 
+  FILE *out = openOutput(outPath);
   moveFront(list);
   while(index(list) >= 0) {
-    fprintf(out, "%s\n", words[get(list)]);
+    writeLine(out, &lines[get(list)]);
     moveNext(list);
   }
+  fclose(out);
 
   freeList(&list);
+  free(lines);
+  closeInput(&in);
+}
+
+// External sort ---------------------------------------------------------------
+// Sorted runs are spilled to tmpfile()s as (size_t length, bytes) records and
+// then k-way merged, at most MERGE_FANIN runs at a time. Ties between runs go
+// to the earlier run, so the output is the same as the in-memory sort.
+
+#define MERGE_FANIN 64
+#define MIN_MEMORY (64 << 10)
+
+typedef struct RunObj {
+  FILE *fp;
+  char *buf;
+  size_t cap;
+  Line cur;
+} Run;
+
+static void writeRecord(FILE *out, const Line *l) {
+  if(fwrite(&l->len, sizeof(l->len), 1, out) != 1
+     || fwrite(l->str, 1, l->len, out) != l->len) {
+    fprintf(stderr, "failed to write temporary run\n");
+    exit(1);
+  }
+}
+
+// Loads the next record of r into r->cur, returns 0 when the run is done.
+static int nextRecord(Run *r) {
+  size_t len;
+  if(fread(&len, sizeof(len), 1, r->fp) != 1) return 0;
+  if(len > r->cap) {
+    r->cap = len;
+    r->buf = (char*)realloc(r->buf, r->cap);
+  }
+  if(fread(r->buf, 1, len, r->fp) != len) {
+    fprintf(stderr, "failed to read temporary run\n");
+    exit(1);
+  }
+  makeLine(&r->cur, r->buf, len);
+  return 1;
+}
+
+static FILE *newRunFile(void) {
+  FILE *fp = tmpfile();
+  if(fp == NULL) {
+    fprintf(stderr, "failed to create temporary run\n");
+    exit(1);
+  }
+  return fp;
+}
+
+static int runLess(const Run *runs, int a, int b) {
+  int c = compareLine(&runs[a].cur, &runs[b].cur);
+  return c < 0 || (c == 0 && a < b);
+}
+
+static void siftDown(const Run *runs, int *heap, int n, int i) {
+  for(;;) {
+    int l = 2 * i + 1, r = l + 1, m = i;
+    if(l < n && runLess(runs, heap[l], heap[m])) m = l;
+    if(r < n && runLess(runs, heap[r], heap[m])) m = r;
+    if(m == i) return;
+    int t = heap[i];
+    heap[i] = heap[m];
+    heap[m] = t;
+    i = m;
+  }
+}
+
+// Merges files[0..k) into out, as text lines when text is set and as run
+// records otherwise. The input files are closed.
+static void mergeRuns(FILE **files, int k, FILE *out, int text) {
+  Run *runs = (Run*)calloc(1, sizeof(Run) * k);
+  int *heap = (int*)calloc(1, sizeof(int) * k);
+  int n = 0;
+  for(int i = 0; i < k; i++) {
+    runs[i].fp = files[i];
+    rewind(runs[i].fp);
+    if(nextRecord(&runs[i])) heap[n++] = i;
+  }
+  for(int i = n / 2 - 1; i >= 0; i--) {
+    siftDown(runs, heap, n, i);
+  }
+  while(n > 0) {
+    Run *r = &runs[heap[0]];
+    if(text) {
+      writeLine(out, &r->cur);
+    } else {
+      writeRecord(out, &r->cur);
+    }
+    if(!nextRecord(r)) heap[0] = heap[--n];
+    siftDown(runs, heap, n, 0);
+  }
+  for(int i = 0; i < k; i++) {
+    fclose(runs[i].fp);
+    free(runs[i].buf);
+  }
+  free(runs);
+  free(heap);
+}
+
+// Per-line memory of a sort besides the text: the Line, the order array and
+// the scratch arrays of the sort.
+#define LINE_OVERHEAD (sizeof(Line) + 2 * sizeof(int) + 2 * sizeof(KeyEntry))
+
+// Sorts the file at path into outPath using about memLimit bytes: half for
+// line text, half for the per-line arrays of a run.
+static void sortExternal(const char *path, const char *outPath, size_t memLimit, int threads) {
+  FILE *in = fopen(path, "rb");
+  if(in == NULL) {
+    fprintf(stderr, "faile to open file %s\n", path);
+    exit(1);
+  }
+  size_t cap = memLimit / 2, have = 0;
+  int maxLines = (int)(memLimit / 2 / LINE_OVERHEAD);
+  char *buf = (char*)malloc(cap);
+  Line *lines = (Line*)malloc(sizeof(Line) * maxLines);
+  int *order = (int*)malloc(sizeof(int) * maxLines);
+  FILE **runs = NULL, *out = NULL;
+  int nRuns = 0, runCap = 0;
+  int eof = 0;
+
+  while(!eof || have > 0) {
+    if(!eof) {
+      have += fread(buf + have, 1, cap - have, in);
+      if(have < cap) {
+        if(ferror(in)) {
+          fprintf(stderr, "failed to read file %s\n", path);
+          exit(1);
+        }
+        eof = 1;
+      }
+    }
+    int cnt = 0;
+    const char *cur = buf, *end = buf + have;
+    while(cnt < maxLines && cur < end) {
+      const char *nl = memchr(cur, '\n', (size_t)(end - cur));
+      if(nl == NULL && !eof) break;
+      size_t len = (nl == NULL) ? (size_t)(end - cur) : (size_t)(nl - cur);
+      makeLine(&lines[cnt++], cur, len);
+      cur += len + 1;
+    }
+    if(cur > end) cur = end;
+    if(cnt == 0) {
+      // one line does not fit in the buffer, the buffer has to grow
+      cap *= 2;
+      buf = (char*)realloc(buf, cap);
+      continue;
+    }
+    sortLines(lines, order, cnt, threads);
+    if(nRuns == 0 && eof && cur == end) {
+      // everything fit in a single run, no need to spill
+      out = openOutput(outPath);
+      for(int i = 0; i < cnt; i++) {
+        writeLine(out, &lines[order[i]]);
+      }
+    } else {
+      if(nRuns == runCap) {
+        runCap = runCap ? runCap * 2 : 16;
+        runs = (FILE**)realloc(runs, sizeof(FILE*) * runCap);
+      }
+      FILE *run = newRunFile();
+      for(int i = 0; i < cnt; i++) {
+        writeRecord(run, &lines[order[i]]);
+      }
+      runs[nRuns++] = run;
+    }
+    have = (size_t)(end - cur);
+    memmove(buf, cur, have);
+  }
   fclose(in);
+  free(buf);
+  free(lines);
+  free(order);
+
+  while(nRuns > MERGE_FANIN) {
+    int m = 0;
+    for(int i = 0; i < nRuns; i += MERGE_FANIN) {
+      int k = (nRuns - i < MERGE_FANIN) ? nRuns - i : MERGE_FANIN;
+      FILE *merged = newRunFile();
+      mergeRuns(runs + i, k, merged, 0);
+      runs[m++] = merged;
+    }
+    nRuns = m;
+  }
+  if(out == NULL) out = openOutput(outPath);
+  if(nRuns > 0) mergeRuns(runs, nRuns, out, 1);
   fclose(out);
-  for(int i = 0; i < line; i++) {
-    free(words[i]);
+  free(runs);
+}
+
+// Parses a byte count with an optional K, M or G suffix.
+static size_t parseSize(const char *s) {
+  char *end;
+  unsigned long long n = strtoull(s, &end, 10);
+  switch(*end) {
+    case 'k': case 'K': n <<= 10; end++; break;
+    case 'm': case 'M': n <<= 20; end++; break;
+    case 'g': case 'G': n <<= 30; end++; break;
+  }
+  if(end == s || *end != 0 || n == 0) {
+    fprintf(stderr, "invalid memory limit %s\n", s);
+    exit(1);
+  }
+  return n < MIN_MEMORY ? MIN_MEMORY : (size_t)n;
+}
+
+// The in-memory sort needs the text plus LINE_OVERHEAD bytes per line, so
+// only inputs up to half of the limit stay in memory.
+static int fitsInMemory(const char *path, size_t memLimit) {
+  struct stat st;
+  if(stat(path, &st) < 0) {
+    fprintf(stderr, "faile to open file %s\n", path);
+    exit(1);
   }
-  free(words);
+  return S_ISREG(st.st_mode) && (size_t)st.st_size <= memLimit / 2;
+}
+
+// Whether a and b name the same file (b does not have to exist yet).
+static int sameFile(const char *a, const char *b) {
+  struct stat sa, sb;
+  if(stat(a, &sa) < 0 || stat(b, &sb) < 0) return 0;
+  return sa.st_dev == sb.st_dev && sa.st_ino == sb.st_ino;
+}
 
-}
\ No newline at end of file
+static void usage(void) {
+  fprintf(stderr, "correct format is: Lex [-m <memory limit>] [-t <threads>] <input file> <output file>\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  size_t memLimit = 0;
+  int threads = 1;
+  int argi = 1;
+  while(argi < argc && argv[argi][0] == '-' && argv[argi][1] != 0) {
+    if(strcmp(argv[argi], "-m") == 0 && argi + 1 < argc) {
+      memLimit = parseSize(argv[argi + 1]);
+      argi += 2;
+    } else if(strcmp(argv[argi], "-t") == 0 && argi + 1 < argc) {
+      char *end;
+      long t = strtol(argv[argi + 1], &end, 10);
+      if(end == argv[argi + 1] || *end != 0 || t < 0 || t > 1024) {
+        fprintf(stderr, "invalid thread count %s\n", argv[argi + 1]);
+        exit(1);
+      }
+      // 0 means one thread per online core
+      threads = (t == 0) ? (int)sysconf(_SC_NPROCESSORS_ONLN) : (int)t;
+      if(threads < 1) threads = 1;
+      argi += 2;
+    } else {
+      usage();
+    }
+  }
+  if(argc - argi != 2) usage();
+  const char *inPath = argv[argi], *outPath = argv[argi + 1];
+  int inPlace = sameFile(inPath, outPath);
+  if(memLimit > 0 && !fitsInMemory(inPath, memLimit)) {
+    sortExternal(inPath, outPath, memLimit, threads);
+  } else {
+    sortInMemory(inPath, outPath, threads, inPlace);
+  }
+}
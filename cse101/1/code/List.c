@@ -13,6 +13,7 @@
 #include "List.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 ListNode *newListNode(int x) {
   ListNode *node= (ListNode*)calloc(1, sizeof(ListNode));
@@ -20,6 +21,203 @@ ListNode *newListNode(int x) {
   return node;
 }
 
+// The doubly linked backend. With -DLIST_UNROLLED the List lives in
+// ListUnrolled.c instead.
+#ifndef LIST_UNROLLED
+
+#ifdef LIST_POOL
+#define POOL_MIN_BLOCK 16
+#define POOL_MAX_BLOCK 4096
+
+// Makes a fresh block of cap nodes the one L carves from.
+static void newBlock(List L, int cap) {
+  ListBlock *block = (ListBlock*)malloc(sizeof(ListBlock) + sizeof(ListNode) * cap);
+  if(block == NULL) {
+    fprintf(stderr, "|> %s - %d: out of memory\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  block->cap = cap;
+  block->next = L->blocks;
+  if(L->blocks == NULL) L->lastBlock = block;
+  L->blocks = block;
+  L->used = 0;
+}
+
+// Nodes of L come from its own blocks. Block sizes double from
+// POOL_MIN_BLOCK up to POOL_MAX_BLOCK, so short lists stay small.
+static ListNode *takeNode(List L, int x) {
+  ListNode *node = L->freeNodes;
+  if(node != NULL) {
+    L->freeNodes = node->next;
+  } else {
+    if(L->blocks == NULL || L->used == L->blocks->cap) {
+      int cap = (L->blocks == NULL) ? POOL_MIN_BLOCK : L->blocks->cap * 2;
+      if(cap > POOL_MAX_BLOCK) cap = POOL_MAX_BLOCK;
+      newBlock(L, cap);
+    }
+    node = &L->blocks->nodes[L->used++];
+  }
+  node->data = x;
+  node->next = NULL;
+  node->pre = NULL;
+  return node;
+}
+
+static void dropNode(List L, ListNode *node) {
+  node->next = L->freeNodes;
+  L->freeNodes = node;
+}
+
+// Makes sure the next n takeNode calls are served from one block.
+static void reserveNodes(List L, int n) {
+  if(L->blocks != NULL && L->blocks->cap - L->used >= n) return;
+  if(n > 0) newBlock(L, n > POOL_MIN_BLOCK ? n : POOL_MIN_BLOCK);
+}
+
+// Hands the blocks of B over to A, so nodes spliced from B stay valid.
+static void moveBlocks(List A, List B) {
+  if(B->blocks == NULL) return;
+  if(A->blocks == NULL) {
+    A->blocks = B->blocks;
+    A->used = B->used;
+  } else {
+    // A keeps carving from its own newest block
+    A->lastBlock->next = B->blocks;
+  }
+  A->lastBlock = B->lastBlock;
+  if(A->freeNodes == NULL) A->freeNodes = B->freeNodes;
+  B->blocks = NULL;
+  B->lastBlock = NULL;
+  B->freeNodes = NULL;
+  B->used = 0;
+}
+
+static void releaseNodes(List L) {
+  while(L->blocks != NULL) {
+    ListBlock *needDelete = L->blocks;
+    L->blocks = L->blocks->next;
+    free(needDelete);
+  }
+  L->freeNodes = NULL;
+  L->lastBlock = NULL;
+  L->used = 0;
+  L->head = NULL;
+  L->tail = NULL;
+}
+#else
+static ListNode *takeNode(List L, int x) {
+  (void)L;
+  return newListNode(x);
+}
+
+static void dropNode(List L, ListNode *node) {
+  (void)L;
+  free(node);
+}
+
+static void reserveNodes(List L, int n) {
+  (void)L;
+  (void)n;
+}
+
+static void moveBlocks(List A, List B) {
+  (void)A;
+  (void)B;
+}
+
+static void releaseNodes(List L) {
+  while(L->head != NULL) {
+    ListNode *needDelete = L->head;
+    L->head = L->head->next;
+    free(needDelete);
+  }
+  L->tail = NULL;
+}
+#endif
+
+// Skip index -----------------------------------------------------------------
+
+#define SKIP_MIN_SIZE 32
+
+static void skipFree(List L) {
+  if(L->skip == NULL) return;
+  free(L->skip->first);
+  free(L->skip->count);
+  free(L->skip);
+  L->skip = NULL;
+}
+
+static void skipInsertSeg(ListSkip *sk, int s, ListNode *first, int count) {
+  if(sk->segs == sk->cap) {
+    sk->cap = sk->cap ? sk->cap * 2 : 16;
+    sk->first = (ListNode**)realloc(sk->first, sizeof(ListNode*) * sk->cap);
+    sk->count = (int*)realloc(sk->count, sizeof(int) * sk->cap);
+  }
+  memmove(sk->first + s + 1, sk->first + s, sizeof(ListNode*) * (sk->segs - s));
+  memmove(sk->count + s + 1, sk->count + s, sizeof(int) * (sk->segs - s));
+  sk->first[s] = first;
+  sk->count[s] = count;
+  sk->segs += 1;
+}
+
+// Drops the now empty segment s, keeping cseg on the same segment.
+static void skipRemoveSeg(List L, int s) {
+  ListSkip *sk = L->skip;
+  memmove(sk->first + s, sk->first + s + 1, sizeof(ListNode*) * (sk->segs - s - 1));
+  memmove(sk->count + s, sk->count + s + 1, sizeof(int) * (sk->segs - s - 1));
+  sk->segs -= 1;
+  if(L->cursor != NULL && sk->cseg > s) sk->cseg -= 1;
+}
+
+static void skipBuild(List L) {
+  skipFree(L);
+  ListSkip *sk = (ListSkip*)calloc(1, sizeof(ListSkip));
+  L->skip = sk;
+  int size = SKIP_MIN_SIZE;
+  while(size * size < L->cnt) size *= 2;
+  sk->size = size;
+  int k = 0;
+  for(ListNode *cur = L->head; cur != NULL; cur = cur->next, k++) {
+    if(k % size == 0) skipInsertSeg(sk, sk->segs, cur, 0);
+    sk->count[sk->segs - 1] += 1;
+    if(cur == L->cursor) sk->cseg = sk->segs - 1;
+  }
+}
+
+// Splits segment s in two once it grew past twice the target size.
+static void skipSplit(List L, int s) {
+  ListSkip *sk = L->skip;
+  if(sk->count[s] <= 2 * sk->size) return;
+  ListNode *mid = sk->first[s];
+  int cursorInFirst = 0;
+  for(int k = 0; k < sk->size; k++) {
+    if(mid == L->cursor) cursorInFirst = 1;
+    mid = mid->next;
+  }
+  skipInsertSeg(sk, s + 1, mid, sk->count[s] - sk->size);
+  sk->count[s] = sk->size;
+  if(L->cursor != NULL && (sk->cseg > s || (sk->cseg == s && !cursorInFirst))) {
+    sk->cseg += 1;
+  }
+}
+
+// Segment s gained a node.
+static void skipGrow(List L, int s) {
+  L->skip->count[s] += 1;
+  skipSplit(L, s);
+}
+
+// Segment s lost a node; next is the node after the removed one.
+static void skipShrink(List L, int s, ListNode *removed, ListNode *next) {
+  ListSkip *sk = L->skip;
+  sk->count[s] -= 1;
+  if(sk->count[s] == 0) {
+    skipRemoveSeg(L, s);
+  } else if(sk->first[s] == removed) {
+    sk->first[s] = next;
+  }
+}
+
 
 List newList(void) {
   List list = calloc(1, sizeof(ListObj));
@@ -32,11 +230,8 @@ void freeList(List* pL) {
     fprintf(stderr, "|> %s - %d: free list is null\n", __FILE__, __LINE__);
     exit(1);
   }
-  while((*pL)->head != NULL) {
-    ListNode *needDelete = (*pL)->head;
-    (*pL)->head = (*pL)->head->next;
-    free(needDelete);
-  }
+  skipFree(*pL);
+  releaseNodes(*pL);
   free(*pL);
   *pL = NULL;
 }
@@ -70,12 +265,7 @@ int get(List L) {
     fprintf(stderr, "|> %s - %d: list cursor error\n", __FILE__, __LINE__);
     exit(1);
   }
-  int k = L->idx;
-  ListNode *cur = L->head;
-  while(k--) {
-    cur = cur->next;
-  }
-  return cur->data;
+  return L->cursor->data;
 }
 
 bool equals(List A, List B) {
@@ -96,13 +286,10 @@ bool equals(List A, List B) {
 
 void clear(List L) {
   L->idx = -1;
-  while(L->cnt--) {
-    ListNode *needDelete = L->head;
-    L->head = L->head->next;
-    free(needDelete);
-  }
-  L->head = NULL;
-  L->tail = NULL;
+  L->cursor = NULL;
+  L->cnt = 0;
+  skipFree(L);
+  releaseNodes(L);
 }
 
 void set(List L, int x) {
@@ -110,81 +297,110 @@ void set(List L, int x) {
     fprintf(stderr, "|> %s - %d: list cursor error\n", __FILE__, __LINE__);
     exit(1);
   }
-  int k = L->idx;
-  ListNode *cur = L->head;
-  while(k--) {
-    cur = cur->next;
-  }
-  cur->data = x;
+  L->cursor->data = x;
 }
  
 void moveFront(List L) {
-  if(L->cnt > 0) L->idx = 0;
+  if(L->cnt > 0) {
+    L->idx = 0;
+    L->cursor = L->head;
+    if(L->skip != NULL) L->skip->cseg = 0;
+  }
 }
  
 void moveBack(List L) {
-  if(L->cnt > 0) L->idx = L->cnt - 1;
+  if(L->cnt > 0) {
+    L->idx = L->cnt - 1;
+    L->cursor = L->tail;
+    if(L->skip != NULL) L->skip->cseg = L->skip->segs - 1;
+  }
 }
  
 void movePrev(List L) {
   if(L->idx >= 0 && L->idx < L->cnt) {
+    if(L->skip != NULL && L->cursor == L->skip->first[L->skip->cseg]) {
+      L->skip->cseg -= 1;
+    }
     L->idx -= 1;
+    L->cursor = L->cursor->pre;
   } 
 }
  
 void moveNext(List L) {
   if(L->idx >=0 && L->idx < L->cnt - 1 ) {
     L->idx += 1;
+    L->cursor = L->cursor->next;
+    ListSkip *sk = L->skip;
+    if(sk != NULL && sk->cseg + 1 < sk->segs && L->cursor == sk->first[sk->cseg + 1]) {
+      sk->cseg += 1;
+    }
   } else {
     L->idx = -1;
+    L->cursor = NULL;
   }
 }
 
 void prepend(List L, int x) {
   if(L->head == NULL) {
-    L->head = newListNode(x);
+    L->head = takeNode(L, x);
     L->tail = L->head;
   } else {
-    ListNode *node = newListNode(x);
+    ListNode *node = takeNode(L, x);
     node->next = L->head;
     L->head->pre = node;
     L->head = node;
   }
   L->cnt += 1;
-  moveNext(L);
+  if(L->idx >= 0) L->idx += 1;
+  if(L->skip != NULL) {
+    if(L->skip->segs == 0) {
+      skipInsertSeg(L->skip, 0, L->head, 1);
+    } else {
+      L->skip->first[0] = L->head;
+      skipGrow(L, 0);
+    }
+  }
 }
  
 void append(List L, int x) {
   if(L->head == NULL) {
-    L->head = newListNode(x);
+    L->head = takeNode(L, x);
     L->tail = L->head;
   } else {
-    ListNode *node = newListNode(x);
+    ListNode *node = takeNode(L, x);
     node->pre = L->tail;
     L->tail->next = node;
     L->tail = node;
   }
   L->cnt += 1;
+  if(L->skip != NULL) {
+    if(L->skip->segs == 0) {
+      skipInsertSeg(L->skip, 0, L->tail, 1);
+    } else {
+      skipGrow(L, L->skip->segs - 1);
+    }
+  }
 }
  
 void insertBefore(List L, int x) {
   if(L->idx >= 0 && L->idx < L->cnt) {
-    int idx = L->idx;
-    if(idx == 0) {
+    if(L->idx == 0) {
       prepend(L, x);
     } else {
-      ListNode *cur = L->head;
-      while(idx--) {
-        cur = cur->next;
-      }
+      ListNode *cur = L->cursor;
       // printf("insert before: %d   %d\n", L->idx, cur->data);
-      ListNode *node = newListNode(x);
+      ListNode *node = takeNode(L, x);
       node->next = cur;
       node->pre = cur->pre;
       cur->pre->next = node;
       cur->pre = node;
       L->cnt += 1;
-      moveNext(L);
+      L->idx += 1;
+      if(L->skip != NULL) {
+        // a node in front of a segment's first node ends the previous one
+        int s = L->skip->cseg;
+        skipGrow(L, (cur == L->skip->first[s]) ? s - 1 : s);
+      }
     }
   } else {
     fprintf(stderr, "|> %s - %d: list index error!\n", __FILE__, __LINE__);
@@ -194,20 +410,17 @@ void insertBefore(List L, int x) {
  
 void insertAfter(List L, int x) {
   if(L->idx >= 0 && L->idx < L->cnt) {
-    int idx = L->idx;
-    if(idx == L->cnt - 1) {
+    if(L->idx == L->cnt - 1) {
       append(L, x);
     } else {
-      ListNode *cur = L->head;
-      while(idx--) {
-        cur = cur->next;
-      }
-      ListNode *node = newListNode(x);
+      ListNode *cur = L->cursor;
+      ListNode *node = takeNode(L, x);
       node->next = cur->next;
       node->pre = cur;
       cur->next->pre = node;
       cur->next = node;
       L->cnt += 1;
+      if(L->skip != NULL) skipGrow(L, L->skip->cseg);
     }
   }
 }
@@ -221,9 +434,15 @@ void deleteFront(List L) {
     } else {
       L->head->pre = NULL;
     }
-    free(needDelete);
+    if(L->skip != NULL) skipShrink(L, 0, needDelete, L->head);
+    dropNode(L, needDelete);
     L->cnt -= 1;
-    movePrev(L);
+    if(L->idx == 0) {
+      L->idx = -1;
+      L->cursor = NULL;
+    } else if(L->idx > 0) {
+      L->idx -= 1;
+    }
   } else {
     fprintf(stderr, "|> %s - %d: list is empty!\n", __FILE__, __LINE__);
     exit(1);
@@ -239,8 +458,13 @@ void deleteBack(List L) {
     } else {
       L->tail->next = NULL;
     }
-    free(needDelete);
+    if(L->skip != NULL) skipShrink(L, L->skip->segs - 1, needDelete, NULL);
+    dropNode(L, needDelete);
     L->cnt -= 1;
+    if(L->cursor == needDelete) {
+      L->idx = -1;
+      L->cursor = NULL;
+    }
   } else {
     fprintf(stderr, "|> %s - %d: list is empty!\n", __FILE__, __LINE__);
     exit(1);
@@ -248,11 +472,7 @@ void deleteBack(List L) {
 }
 
 void delete(List L) {
-  int idx = L->idx;
-  ListNode *cur = L->head;
-  while(idx--) {
-    cur = cur->next;
-  }
+  ListNode *cur = L->cursor;
   if(cur == L->head) {
     deleteFront(L);
   } else if(cur == L->tail) {
@@ -260,10 +480,12 @@ void delete(List L) {
   } else {
     cur->pre->next = cur->next;
     cur->next->pre = cur->pre;
-    free(cur);
+    if(L->skip != NULL) skipShrink(L, L->skip->cseg, cur, cur->next);
+    dropNode(L, cur);
     L->cnt -= 1;
   }
   L->idx = -1;
+  L->cursor = NULL;
 }
  
 
@@ -286,6 +508,7 @@ void printList(FILE* out, List L) {
 
 List copyList(List L) {
   List nl = newList();
+  reserveNodes(nl, L->cnt);
   ListNode *cur = L->head;
   while(cur != NULL) {
     append(nl, cur->data);
@@ -297,6 +520,7 @@ List copyList(List L) {
 
 List concatList(List A, List B) {
   List l = newList();
+  reserveNodes(l, A->cnt + B->cnt);
   ListNode *cur = A->head;
   while(cur != NULL) {
     append(l, cur->data);
@@ -308,4 +532,87 @@ List concatList(List A, List B) {
     cur = cur->next;
   }
   return l;
-}
\ No newline at end of file
+}
+
+List newListFromArray(int *A, int n) {
+  List L = newList();
+  reserveNodes(L, n);
+  ListNode *last = NULL;
+  for(int i = 0; i < n; i++) {
+    ListNode *node = takeNode(L, A[i]);
+    node->pre = last;
+    if(last != NULL) {
+      last->next = node;
+    } else {
+      L->head = node;
+    }
+    last = node;
+  }
+  L->tail = last;
+  L->cnt = n;
+  return L;
+}
+
+void listToArray(List L, int *A) {
+  int i = 0;
+  for(ListNode *cur = L->head; cur != NULL; cur = cur->next) {
+    A[i++] = cur->data;
+  }
+}
+
+void moveTo(List L, int i) {
+  if(i < 0 || i >= L->cnt) {
+    fprintf(stderr, "|> %s - %d: list index error!\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  ListSkip *sk = L->skip;
+  if(sk == NULL || (long long)sk->segs * sk->segs > 4LL * L->cnt + 64
+     || (long long)sk->size * sk->size > 4LL * L->cnt + 64) {
+    // first use, or the segments drifted far from sqrt(n)
+    skipBuild(L);
+    sk = L->skip;
+  }
+  int s, start;
+  if(i < L->cnt / 2) {
+    s = 0;
+    start = 0;
+    while(start + sk->count[s] <= i) {
+      start += sk->count[s++];
+    }
+  } else {
+    s = sk->segs - 1;
+    start = L->cnt - sk->count[s];
+    while(start > i) {
+      start -= sk->count[--s];
+    }
+  }
+  ListNode *cur = sk->first[s];
+  for(int k = start; k < i; k++) {
+    cur = cur->next;
+  }
+  L->cursor = cur;
+  L->idx = i;
+  sk->cseg = s;
+}
+
+void spliceList(List A, List B) {
+  if(A == B || B->head == NULL) return;
+  skipFree(A);
+  skipFree(B);
+  if(A->head == NULL) {
+    A->head = B->head;
+  } else {
+    A->tail->next = B->head;
+    B->head->pre = A->tail;
+  }
+  A->tail = B->tail;
+  A->cnt += B->cnt;
+  moveBlocks(A, B);
+  B->head = NULL;
+  B->tail = NULL;
+  B->cursor = NULL;
+  B->cnt = 0;
+  B->idx = -1;
+}
+
+#endif // LIST_UNROLLED
@@ -21,11 +21,80 @@ typedef struct NodeObj {
   struct NodeObj *pre;
 }ListNode;
 
+#ifdef LIST_UNROLLED
+// Unrolled backend (build with -DLIST_UNROLLED): the list is a chain of
+// 128-byte chunks holding up to LIST_CHUNK_INTS elements each, and the
+// cursor is a (chunk, offset) pair. Same API and cursor semantics.
+#define LIST_CHUNK_INTS 27
+
+typedef struct ChunkObj {
+  struct ChunkObj *next;
+  struct ChunkObj *pre;
+  int cnt;
+  int data[LIST_CHUNK_INTS];
+}ListChunk;
+
+// Optional chunk directory, built by the first moveTo() on a List and kept up
+// to date by every later insert and delete. The chunks are cut into groups of
+// about sqrt(chunks) consecutive chunks, each remembered by its first chunk,
+// its element count and its chunk count, so moveTo() scans the element counts
+// and hops chunks inside one group.
+typedef struct DirObj {
+  ListChunk **first;
+  int *count; // elements in each group
+  int *span;  // chunks in each group
+  int groups, cap;
+  int size;   // chunks per group at the last rebuild, groups split at 2 * size
+  int total;  // chunks in the list
+  int cgroup; // group holding the cursor chunk, when the cursor is defined
+}ListDir;
+
+typedef struct ListObj{
+  int idx;
+  int cnt;
+  ListChunk *head, *tail;
+  ListChunk *cursor; // chunk holding the cursor element, NULL when undefined
+  int off;           // offset of the cursor element inside cursor
+  ListDir *dir;      // NULL until moveTo() is used
+}ListObj;
+#else
+// Optional skip index, built by the first moveTo() on a List and kept up to
+// date by every later insert and delete. The list is cut into segments of
+// about sqrt(n) consecutive nodes, each remembered by its first node and its
+// length, so moveTo() scans the segment lengths and walks inside one segment.
+typedef struct SkipObj {
+  ListNode **first;
+  int *count;
+  int segs, cap;
+  int size;  // segment length at the last rebuild, segments split at 2 * size
+  int cseg;  // segment holding the cursor node, when the cursor is defined
+}ListSkip;
+
+#ifdef LIST_POOL
+// Slab of nodes owned by one List (build with -DLIST_POOL). Nodes are carved
+// from the newest block, recycled through a free list on delete, and all
+// blocks are released at once by clear/freeList.
+typedef struct BlockObj {
+  struct BlockObj *next;
+  int cap;
+  ListNode nodes[];
+}ListBlock;
+#endif
+
 typedef struct ListObj{
   int idx;
   int cnt;
   ListNode *head, *tail;
+  ListNode *cursor; // node under idx, NULL when the cursor is undefined
+  ListSkip *skip;    // NULL until moveTo() is used
+#ifdef LIST_POOL
+  ListNode *freeNodes; // deleted nodes, chained through next
+  ListBlock *blocks;   // newest block first
+  ListBlock *lastBlock; // oldest block, for O(1) splicing of block chains
+  int used;            // nodes carved from blocks so far
+#endif
 }ListObj;
+#endif
 
 typedef ListObj* List;
 
@@ -80,4 +149,18 @@ List copyList(List L); // Returns a new List representing the same integer
 // regardless of the state of the cursor in L. The state 
 // of L is unchanged.
 
-List concatList(List A, List B);
\ No newline at end of file
+List concatList(List A, List B);
+
+// Bulk operations ------------------------------------------------------------
+List newListFromArray(int *A, int n); // Returns a new List holding A[0..n) in
+ // order, built in one pass (one node allocation with
+ // -DLIST_POOL). The cursor is undefined.
+void listToArray(List L, int *A); // Copies the elements of L, front to back,
+ // into A, which must hold length(L) ints. L is unchanged.
+void moveTo(List L, int i); // Places the cursor under element i in sublinear
+ // time (sqrt(n) skip index or, with -DLIST_UNROLLED,
+ // sqrt(chunks) chunk directory, built on first use).
+ // Pre: 0<=i<length()
+void spliceList(List A, List B); // Moves every element of B to the back of A
+ // in O(1), without copying. B becomes empty with an
+ // undefined cursor; the cursor of A is unchanged.
\ No newline at end of file
@@ -0,0 +1,286 @@
+/**
+ * @file ListBench.c
+ * @author your name (you@domain.com)
+ * @CruzID xx
+ * @assignment pa1
+ * @brief Micro-benchmarks for the List ADT, see make bench
+ * @version 0.1
+ * @date 2023-01-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "List.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Allocations are counted by linking with -Wl,--wrap=malloc and friends, so
+// every malloc/calloc/realloc/aligned_alloc made inside List.c lands here.
+static long long allocs;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t n, size_t size);
+void *__real_realloc(void *p, size_t size);
+void *__real_aligned_alloc(size_t align, size_t size);
+
+void *__wrap_malloc(size_t size) {
+  allocs++;
+  return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t n, size_t size) {
+  allocs++;
+  return __real_calloc(n, size);
+}
+
+void *__wrap_realloc(void *p, size_t size) {
+  allocs++;
+  return __real_realloc(p, size);
+}
+
+void *__wrap_aligned_alloc(size_t align, size_t size) {
+  allocs++;
+  return __real_aligned_alloc(align, size);
+}
+
+#if defined(LIST_UNROLLED)
+#define BACKEND "unrolled"
+#elif defined(LIST_POOL)
+#define BACKEND "pool"
+#else
+#define BACKEND "linked"
+#endif
+
+// every case runs at least this many operations per size
+#define MIN_OPS 1000000
+// mid-list deletes walk to the middle again after each delete
+#define DELETE_OPS 100
+// same, when moveTo finds the middle
+#define DELETE_AT_OPS 10000
+
+static volatile long long sink;
+
+static double now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void report(const char *name, int n, long long ops, double ns, long long a) {
+  printf("%-8s %-10s %9d %12.2f %10.3f\n", BACKEND, name, n, ns / ops, (double)a / ops);
+}
+
+static List build(int n) {
+  List L = newList();
+  for(int i = 0; i < n; i++) {
+    append(L, i);
+  }
+  return L;
+}
+
+static void seek(List L, int k) {
+  moveFront(L);
+  while(k-- > 0) {
+    moveNext(L);
+  }
+}
+
+static void benchAppend(int n, int reps) {
+  double ns = 0;
+  long long a = 0;
+  for(int r = 0; r < reps; r++) {
+    List L = newList();
+    long long a0 = allocs;
+    double t0 = now();
+    for(int i = 0; i < n; i++) {
+      append(L, i);
+    }
+    ns += now() - t0;
+    a += allocs - a0;
+    freeList(&L);
+  }
+  report("append", n, (long long)n * reps, ns, a);
+}
+
+static void benchPrepend(int n, int reps) {
+  double ns = 0;
+  long long a = 0;
+  for(int r = 0; r < reps; r++) {
+    List L = newList();
+    long long a0 = allocs;
+    double t0 = now();
+    for(int i = 0; i < n; i++) {
+      prepend(L, i);
+    }
+    ns += now() - t0;
+    a += allocs - a0;
+    freeList(&L);
+  }
+  report("prepend", n, (long long)n * reps, ns, a);
+}
+
+static void benchFromArray(int n, int reps) {
+  int *A = (int*)malloc(sizeof(int) * n);
+  for(int i = 0; i < n; i++) {
+    A[i] = i;
+  }
+  double ns = 0;
+  long long a = 0;
+  for(int r = 0; r < reps; r++) {
+    long long a0 = allocs;
+    double t0 = now();
+    List L = newListFromArray(A, n);
+    ns += now() - t0;
+    a += allocs - a0;
+    freeList(&L);
+  }
+  free(A);
+  report("fromarray", n, (long long)n * reps, ns, a);
+}
+
+static void benchTraverse(int n, int reps) {
+  List L = build(n);
+  long long sum = 0;
+  long long a0 = allocs;
+  double t0 = now();
+  for(int r = 0; r < reps; r++) {
+    moveFront(L);
+    while(index(L) >= 0) {
+      sum += get(L);
+      moveNext(L);
+    }
+  }
+  double ns = now() - t0;
+  long long a = allocs - a0;
+  sink = sum;
+  freeList(&L);
+  report("traverse", n, (long long)n * reps, ns, a);
+}
+
+static void benchInsertMid(int n, int reps) {
+  double ns = 0;
+  long long a = 0;
+  for(int r = 0; r < reps; r++) {
+    List L = build(n);
+    seek(L, n / 2);
+    long long a0 = allocs;
+    double t0 = now();
+    for(int i = 0; i < n; i++) {
+      insertBefore(L, i);
+    }
+    ns += now() - t0;
+    a += allocs - a0;
+    freeList(&L);
+  }
+  report("insertmid", n, (long long)n * reps, ns, a);
+}
+
+// delete() leaves the cursor undefined, so every op pays for finding the
+// middle again
+static void benchDeleteMid(int n) {
+  int ops = n / 2 < DELETE_OPS ? n / 2 : DELETE_OPS;
+  List L = build(n);
+  long long a0 = allocs;
+  double t0 = now();
+  for(int i = 0; i < ops; i++) {
+    seek(L, length(L) / 2);
+    delete(L);
+  }
+  double ns = now() - t0;
+  long long a = allocs - a0;
+  freeList(&L);
+  report("deletemid", n, ops, ns, a);
+}
+
+// random jumps, the cursor lands on a new element every op; the index build
+// of the first moveTo is counted too
+static void benchMoveTo(int n) {
+  List L = build(n);
+  long long sum = 0;
+  unsigned seed = 1;
+  long long a0 = allocs;
+  double t0 = now();
+  for(int i = 0; i < MIN_OPS; i++) {
+    seed = seed * 1103515245u + 12345u;
+    moveTo(L, (int)((seed >> 8) % (unsigned)n));
+    sum += get(L);
+  }
+  double ns = now() - t0;
+  long long a = allocs - a0;
+  sink = sum;
+  freeList(&L);
+  report("moveto", n, MIN_OPS, ns, a);
+}
+
+// deletemid again, with moveTo finding the middle
+static void benchDeleteAt(int n) {
+  int ops = n / 2 < DELETE_AT_OPS ? n / 2 : DELETE_AT_OPS;
+  List L = build(n);
+  moveTo(L, 0);
+  long long a0 = allocs;
+  double t0 = now();
+  for(int i = 0; i < ops; i++) {
+    moveTo(L, length(L) / 2);
+    delete(L);
+  }
+  double ns = now() - t0;
+  long long a = allocs - a0;
+  freeList(&L);
+  report("deleteat", n, ops, ns, a);
+}
+
+static void benchCopy(int n, int reps) {
+  List L = build(n);
+  double ns = 0;
+  long long a = 0;
+  for(int r = 0; r < reps; r++) {
+    long long a0 = allocs;
+    double t0 = now();
+    List C = copyList(L);
+    ns += now() - t0;
+    a += allocs - a0;
+    freeList(&C);
+  }
+  freeList(&L);
+  report("copy", n, (long long)n * reps, ns, a);
+}
+
+static void benchConcat(int n, int reps) {
+  List A = build(n / 2), B = build(n - n / 2);
+  double ns = 0;
+  long long a = 0;
+  for(int r = 0; r < reps; r++) {
+    long long a0 = allocs;
+    double t0 = now();
+    List C = concatList(A, B);
+    ns += now() - t0;
+    a += allocs - a0;
+    freeList(&C);
+  }
+  freeList(&A);
+  freeList(&B);
+  report("concat", n, (long long)n * reps, ns, a);
+}
+
+int main(int argc, char **argv) {
+  int maxN = 10000000;
+  if(argc > 2 || (argc == 2 && (maxN = atoi(argv[1])) < 1000)) {
+    fprintf(stderr, "usage: %s [max n >= 1000]\n", argv[0]);
+    exit(1);
+  }
+  printf("%-8s %-10s %9s %12s %10s\n", "backend", "case", "n", "ns/op", "allocs/op");
+  for(int n = 1000; n <= maxN; n *= 10) {
+    int reps = (n < MIN_OPS) ? MIN_OPS / n : 1;
+    benchAppend(n, reps);
+    benchPrepend(n, reps);
+    benchFromArray(n, reps);
+    benchTraverse(n, reps);
+    benchInsertMid(n, reps);
+    benchDeleteMid(n);
+    benchMoveTo(n);
+    benchDeleteAt(n);
+    benchCopy(n, reps);
+    benchConcat(n, reps);
+  }
+}
@@ -64,7 +64,31 @@ int main() {
   clear(list);
   printList(stdout, list);
 
+  int arr[] = {4, 8, 15, 16, 23, 42};
+  List al = newListFromArray(arr, 6);
+  printList(stdout, al);
+  spliceList(ct, al);
+  printList(stdout, ct);
+  printf("%d %d\n", length(ct), length(al));
+  int out[16] = {0};
+  listToArray(ct, out);
+  for(int i = 0; i < length(ct); i++) {
+    printf("%d ", out[i]);
+  }
+  printf("\n");
+
+  moveTo(ct, 3);
+  printf("%d %d\n", index(ct), get(ct));
+  moveTo(ct, length(ct) - 1);
+  insertBefore(ct, 99);
+  moveTo(ct, 0);
+  delete(ct);
+  moveTo(ct, length(ct) - 2);
+  printf("%d %d\n", index(ct), get(ct));
+  printList(stdout, ct);
+
   freeList(&list);
   freeList(&cl);
   freeList(&ct);
+  freeList(&al);
 }
\ No newline at end of file
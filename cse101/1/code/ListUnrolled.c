@@ -0,0 +1,588 @@
+/**
+ * @file ListUnrolled.c
+ * @author your name (you@domain.com)
+ * @CruzID xx
+ * @assignment pa1
+ * @brief Unrolled List backend, built with -DLIST_UNROLLED
+ * @version 0.1
+ * @date 2023-01-16
+ *
+ * @copyright Copyright (c) 2023
+ *
+ */
+#include "List.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef LIST_UNROLLED
+
+_Static_assert(sizeof(ListChunk) == 128, "ListChunk should fill two cache lines");
+
+static ListChunk *newChunk(void) {
+  ListChunk *c = (ListChunk*)aligned_alloc(64, sizeof(ListChunk));
+  if(c == NULL) {
+    fprintf(stderr, "|> %s - %d: out of memory\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  c->next = NULL;
+  c->pre = NULL;
+  c->cnt = 0;
+  return c;
+}
+
+// Chunk directory ------------------------------------------------------------
+
+#define DIR_MIN_SIZE 8
+
+static void dirFree(List L) {
+  if(L->dir == NULL) return;
+  free(L->dir->first);
+  free(L->dir->count);
+  free(L->dir->span);
+  free(L->dir);
+  L->dir = NULL;
+}
+
+static void dirInsertGroup(ListDir *d, int g, ListChunk *first, int count, int span) {
+  if(d->groups == d->cap) {
+    d->cap = d->cap ? d->cap * 2 : 16;
+    d->first = (ListChunk**)realloc(d->first, sizeof(ListChunk*) * d->cap);
+    d->count = (int*)realloc(d->count, sizeof(int) * d->cap);
+    d->span = (int*)realloc(d->span, sizeof(int) * d->cap);
+  }
+  memmove(d->first + g + 1, d->first + g, sizeof(ListChunk*) * (d->groups - g));
+  memmove(d->count + g + 1, d->count + g, sizeof(int) * (d->groups - g));
+  memmove(d->span + g + 1, d->span + g, sizeof(int) * (d->groups - g));
+  d->first[g] = first;
+  d->count[g] = count;
+  d->span[g] = span;
+  d->groups += 1;
+}
+
+// Drops the now empty group g, keeping cgroup on the same group.
+static void dirRemoveGroup(List L, int g) {
+  ListDir *d = L->dir;
+  memmove(d->first + g, d->first + g + 1, sizeof(ListChunk*) * (d->groups - g - 1));
+  memmove(d->count + g, d->count + g + 1, sizeof(int) * (d->groups - g - 1));
+  memmove(d->span + g, d->span + g + 1, sizeof(int) * (d->groups - g - 1));
+  d->groups -= 1;
+  if(L->cursor != NULL && d->cgroup > g) d->cgroup -= 1;
+}
+
+static void dirBuild(List L) {
+  dirFree(L);
+  ListDir *d = (ListDir*)calloc(1, sizeof(ListDir));
+  L->dir = d;
+  for(ListChunk *c = L->head; c != NULL; c = c->next) {
+    d->total += 1;
+  }
+  int size = DIR_MIN_SIZE;
+  while(size * size < d->total) size *= 2;
+  d->size = size;
+  int k = 0;
+  for(ListChunk *c = L->head; c != NULL; c = c->next, k++) {
+    if(k % size == 0) dirInsertGroup(d, d->groups, c, 0, 0);
+    d->count[d->groups - 1] += c->cnt;
+    d->span[d->groups - 1] += 1;
+    if(c == L->cursor) d->cgroup = d->groups - 1;
+  }
+}
+
+// Group of c, which has to be the cursor, the head or the tail chunk.
+static int dirGroup(List L, ListChunk *c) {
+  if(c == L->cursor) return L->dir->cgroup;
+  return (c == L->head) ? 0 : L->dir->groups - 1;
+}
+
+// Whether b, the chunk after a chunk of group g, belongs to group g too.
+static int dirSameGroup(List L, int g, ListChunk *b) {
+  return L->dir == NULL || g + 1 == L->dir->groups || L->dir->first[g + 1] != b;
+}
+
+// Splits group g in two once it grew past twice the target size.
+static void dirSplit(List L, int g) {
+  ListDir *d = L->dir;
+  if(d->span[g] <= 2 * d->size) return;
+  ListChunk *mid = d->first[g];
+  int count = 0, cursorInFirst = 0;
+  for(int k = 0; k < d->size; k++) {
+    if(mid == L->cursor) cursorInFirst = 1;
+    count += mid->cnt;
+    mid = mid->next;
+  }
+  dirInsertGroup(d, g + 1, mid, d->count[g] - count, d->span[g] - d->size);
+  d->count[g] = count;
+  d->span[g] = d->size;
+  if(L->cursor != NULL && (d->cgroup > g || (d->cgroup == g && !cursorInFirst))) {
+    d->cgroup += 1;
+  }
+}
+
+// The empty chunk n was just linked as the new head or tail of L.
+static void dirLinkEnd(List L, ListChunk *n) {
+  ListDir *d = L->dir;
+  if(d == NULL) return;
+  if(d->groups == 0) dirInsertGroup(d, 0, n, 0, 0);
+  int g = (n == L->head) ? 0 : d->groups - 1;
+  d->first[g] = (n == L->head) ? n : d->first[g];
+  d->span[g] += 1;
+  d->total += 1;
+}
+
+// Chunks ---------------------------------------------------------------------
+
+// Links the empty chunk n into L after c, or at the front when c is NULL.
+static void linkAfter(List L, ListChunk *c, ListChunk *n) {
+  n->pre = c;
+  n->next = (c == NULL) ? L->head : c->next;
+  if(n->next != NULL) {
+    n->next->pre = n;
+  } else {
+    L->tail = n;
+  }
+  if(c != NULL) {
+    c->next = n;
+  } else {
+    L->head = n;
+  }
+}
+
+static void unlinkChunk(List L, ListChunk *c) {
+  if(c->pre != NULL) {
+    c->pre->next = c->next;
+  } else {
+    L->head = c->next;
+  }
+  if(c->next != NULL) {
+    c->next->pre = c->pre;
+  } else {
+    L->tail = c->pre;
+  }
+  free(c);
+}
+
+// Inserts x at offset pos of c (0 <= pos <= c->cnt). A full chunk is split
+// in half first. The cursor stays on its element; L->idx is left to the
+// caller.
+static void insertAt(List L, ListChunk *c, int pos, int x) {
+  ListDir *d = L->dir;
+  int g = (d != NULL) ? dirGroup(L, c) : 0;
+  if(c->cnt == LIST_CHUNK_INTS) {
+    int half = c->cnt / 2;
+    ListChunk *n = newChunk();
+    n->cnt = c->cnt - half;
+    memcpy(n->data, c->data + half, sizeof(int) * n->cnt);
+    c->cnt = half;
+    linkAfter(L, c, n);
+    if(d != NULL) {
+      d->span[g] += 1;
+      d->total += 1;
+    }
+    if(L->cursor == c && L->off >= half) {
+      L->cursor = n;
+      L->off -= half;
+    }
+    if(pos > half) {
+      c = n;
+      pos -= half;
+    }
+  }
+  memmove(c->data + pos + 1, c->data + pos, sizeof(int) * (c->cnt - pos));
+  c->data[pos] = x;
+  c->cnt += 1;
+  if(L->cursor == c && L->off >= pos) L->off += 1;
+  L->cnt += 1;
+  if(d != NULL) {
+    d->count[g] += 1;
+    dirSplit(L, g);
+  }
+}
+
+// Appends the elements of b to a (they fit) and drops b.
+static void mergeInto(List L, ListChunk *a, ListChunk *b) {
+  memcpy(a->data + a->cnt, b->data, sizeof(int) * b->cnt);
+  if(L->cursor == b) {
+    L->cursor = a;
+    L->off += a->cnt;
+  }
+  a->cnt += b->cnt;
+  unlinkChunk(L, b);
+}
+
+// Removes the element at offset pos of c. Removing the cursor element makes
+// the cursor undefined; other changes to L->idx are left to the caller.
+// Chunks that drop below a quarter full are merged into a neighbour of the
+// same directory group.
+static void removeAt(List L, ListChunk *c, int pos) {
+  ListDir *d = L->dir;
+  int g = (d != NULL) ? dirGroup(L, c) : 0;
+  if(L->cursor == c) {
+    if(L->off == pos) {
+      L->cursor = NULL;
+      L->idx = -1;
+    } else if(L->off > pos) {
+      L->off -= 1;
+    }
+  }
+  memmove(c->data + pos, c->data + pos + 1, sizeof(int) * (c->cnt - pos - 1));
+  c->cnt -= 1;
+  L->cnt -= 1;
+  if(d != NULL) d->count[g] -= 1;
+  if(c->cnt == 0) {
+    if(d != NULL) {
+      d->span[g] -= 1;
+      d->total -= 1;
+      if(d->span[g] == 0) {
+        dirRemoveGroup(L, g);
+      } else if(d->first[g] == c) {
+        d->first[g] = c->next;
+      }
+    }
+    unlinkChunk(L, c);
+  } else if(c->cnt < LIST_CHUNK_INTS / 4) {
+    if(c->next != NULL && c->cnt + c->next->cnt <= LIST_CHUNK_INTS
+       && dirSameGroup(L, g, c->next)) {
+      mergeInto(L, c, c->next);
+    } else if(c->pre != NULL && c->pre->cnt + c->cnt <= LIST_CHUNK_INTS
+              && (d == NULL || d->first[g] != c)) {
+      mergeInto(L, c->pre, c);
+    } else {
+      return;
+    }
+    if(d != NULL) {
+      d->span[g] -= 1;
+      d->total -= 1;
+    }
+  }
+}
+
+static void releaseChunks(List L) {
+  while(L->head != NULL) {
+    ListChunk *needDelete = L->head;
+    L->head = L->head->next;
+    free(needDelete);
+  }
+  L->tail = NULL;
+}
+
+List newList(void) {
+  List list = calloc(1, sizeof(ListObj));
+  list->idx = -1;
+  return list;
+}
+
+void freeList(List* pL) {
+  if(*pL == NULL) {
+    fprintf(stderr, "|> %s - %d: free list is null\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  releaseChunks(*pL);
+  dirFree(*pL);
+  free(*pL);
+  *pL = NULL;
+}
+
+int length(List L) {
+  return L->cnt;
+}
+
+int index(List L) {
+  return L->idx;
+}
+
+int front(List L) {
+  if(L->cnt > 0) {
+    return L->head->data[0];
+  }
+  fprintf(stderr, "|> %s - %d: list length <= 0\n", __FILE__, __LINE__);
+  exit(1);
+}
+
+int back(List L) {
+  if(L->cnt > 0) {
+    return L->tail->data[L->tail->cnt - 1];
+  }
+  fprintf(stderr, "|> %s - %d: list length <= 0\n", __FILE__, __LINE__);
+  exit(1);
+}
+
+int get(List L) {
+  if(L->idx < 0 || L->idx >= L->cnt) {
+    fprintf(stderr, "|> %s - %d: list cursor error\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  return L->cursor->data[L->off];
+}
+
+bool equals(List A, List B) {
+  if(A->cnt != B->cnt || A->idx != B->idx) {
+    return 0;
+  }
+  ListChunk *ca = A->head, *cb = B->head;
+  int ia = 0, ib = 0;
+  for(int k = 0; k < A->cnt; k++) {
+    if(ia == ca->cnt) {
+      ca = ca->next;
+      ia = 0;
+    }
+    if(ib == cb->cnt) {
+      cb = cb->next;
+      ib = 0;
+    }
+    if(ca->data[ia++] != cb->data[ib++]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+void clear(List L) {
+  L->idx = -1;
+  L->cursor = NULL;
+  L->cnt = 0;
+  releaseChunks(L);
+  dirFree(L);
+}
+
+void set(List L, int x) {
+  if(L->idx < 0 || L->idx >= L->cnt) {
+    fprintf(stderr, "|> %s - %d: list cursor error\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  L->cursor->data[L->off] = x;
+}
+
+void moveFront(List L) {
+  if(L->cnt > 0) {
+    L->idx = 0;
+    L->cursor = L->head;
+    L->off = 0;
+    if(L->dir != NULL) L->dir->cgroup = 0;
+  }
+}
+
+void moveBack(List L) {
+  if(L->cnt > 0) {
+    L->idx = L->cnt - 1;
+    L->cursor = L->tail;
+    L->off = L->tail->cnt - 1;
+    if(L->dir != NULL) L->dir->cgroup = L->dir->groups - 1;
+  }
+}
+
+void movePrev(List L) {
+  if(L->idx >= 0 && L->idx < L->cnt) {
+    L->idx -= 1;
+    if(L->off > 0) {
+      L->off -= 1;
+    } else {
+      if(L->dir != NULL && L->dir->first[L->dir->cgroup] == L->cursor) L->dir->cgroup -= 1;
+      L->cursor = L->cursor->pre;
+      if(L->cursor != NULL) L->off = L->cursor->cnt - 1;
+    }
+  }
+}
+
+void moveNext(List L) {
+  if(L->idx >= 0 && L->idx < L->cnt - 1) {
+    L->idx += 1;
+    if(L->off < L->cursor->cnt - 1) {
+      L->off += 1;
+    } else {
+      L->cursor = L->cursor->next;
+      L->off = 0;
+      if(L->dir != NULL && !dirSameGroup(L, L->dir->cgroup, L->cursor)) L->dir->cgroup += 1;
+    }
+  } else {
+    L->idx = -1;
+    L->cursor = NULL;
+  }
+}
+
+void prepend(List L, int x) {
+  if(L->head == NULL || L->head->cnt == LIST_CHUNK_INTS) {
+    linkAfter(L, NULL, newChunk());
+    dirLinkEnd(L, L->head);
+  }
+  insertAt(L, L->head, 0, x);
+  if(L->idx >= 0) L->idx += 1;
+}
+
+void append(List L, int x) {
+  if(L->tail == NULL || L->tail->cnt == LIST_CHUNK_INTS) {
+    linkAfter(L, L->tail, newChunk());
+    dirLinkEnd(L, L->tail);
+  }
+  insertAt(L, L->tail, L->tail->cnt, x);
+}
+
+void insertBefore(List L, int x) {
+  if(L->idx >= 0 && L->idx < L->cnt) {
+    insertAt(L, L->cursor, L->off, x);
+    L->idx += 1;
+  } else {
+    fprintf(stderr, "|> %s - %d: list index error!\n", __FILE__, __LINE__);
+    exit(1);
+  }
+}
+
+void insertAfter(List L, int x) {
+  if(L->idx >= 0 && L->idx < L->cnt) {
+    insertAt(L, L->cursor, L->off + 1, x);
+  }
+}
+
+void deleteFront(List L) {
+  if(L->cnt > 0) {
+    int idx = L->idx;
+    removeAt(L, L->head, 0);
+    if(idx > 0) L->idx = idx - 1;
+  } else {
+    fprintf(stderr, "|> %s - %d: list is empty!\n", __FILE__, __LINE__);
+    exit(1);
+  }
+}
+
+void deleteBack(List L) {
+  if(L->cnt > 0) {
+    removeAt(L, L->tail, L->tail->cnt - 1);
+  } else {
+    fprintf(stderr, "|> %s - %d: list is empty!\n", __FILE__, __LINE__);
+    exit(1);
+  }
+}
+
+void delete(List L) {
+  if(L->idx < 0 || L->idx >= L->cnt) {
+    fprintf(stderr, "|> %s - %d: list cursor error\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  removeAt(L, L->cursor, L->off);
+  L->idx = -1;
+  L->cursor = NULL;
+}
+
+void printList(FILE* out, List L) {
+  if(L->head == NULL) {
+    return;
+  }
+  if(out == NULL) {
+    fprintf(stderr, "|> %s - %d: out file is null\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  for(ListChunk *c = L->head; c != NULL; c = c->next) {
+    for(int i = 0; i < c->cnt; i++) {
+      fprintf(out, "%d ", c->data[i]);
+    }
+  }
+  fprintf(out, "\n");
+}
+
+// Appends the elements of src to L a whole chunk at a time.
+static void appendChunks(List L, List src) {
+  for(ListChunk *c = src->head; c != NULL; c = c->next) {
+    ListChunk *n = newChunk();
+    n->cnt = c->cnt;
+    memcpy(n->data, c->data, sizeof(int) * c->cnt);
+    linkAfter(L, L->tail, n);
+    L->cnt += c->cnt;
+  }
+}
+
+List copyList(List L) {
+  List nl = newList();
+  appendChunks(nl, L);
+  return nl;
+}
+
+List concatList(List A, List B) {
+  List l = newList();
+  appendChunks(l, A);
+  appendChunks(l, B);
+  return l;
+}
+
+List newListFromArray(int *A, int n) {
+  List L = newList();
+  for(int i = 0; i < n; i += LIST_CHUNK_INTS) {
+    ListChunk *c = newChunk();
+    c->cnt = (n - i < LIST_CHUNK_INTS) ? n - i : LIST_CHUNK_INTS;
+    memcpy(c->data, A + i, sizeof(int) * c->cnt);
+    linkAfter(L, L->tail, c);
+  }
+  L->cnt = n;
+  return L;
+}
+
+void listToArray(List L, int *A) {
+  for(ListChunk *c = L->head; c != NULL; c = c->next) {
+    memcpy(A, c->data, sizeof(int) * c->cnt);
+    A += c->cnt;
+  }
+}
+
+void moveTo(List L, int i) {
+  if(i < 0 || i >= L->cnt) {
+    fprintf(stderr, "|> %s - %d: list index error!\n", __FILE__, __LINE__);
+    exit(1);
+  }
+  ListChunk *c = L->cursor;
+  if(c != NULL && i >= L->idx - L->off && i < L->idx - L->off + c->cnt) {
+    // still inside the cursor chunk
+    L->off += i - L->idx;
+    L->idx = i;
+    return;
+  }
+  ListDir *d = L->dir;
+  if(d == NULL || (long long)d->groups * d->groups > 4LL * d->total + 64
+     || (long long)d->size * d->size > 4LL * d->total + 64) {
+    // first use, or the groups drifted far from sqrt(chunks)
+    dirBuild(L);
+    d = L->dir;
+  }
+  int g, start;
+  if(i < L->cnt / 2) {
+    g = 0;
+    start = 0;
+    while(start + d->count[g] <= i) {
+      start += d->count[g++];
+    }
+  } else {
+    g = d->groups - 1;
+    start = L->cnt - d->count[g];
+    while(start > i) {
+      start -= d->count[--g];
+    }
+  }
+  c = d->first[g];
+  while(i >= start + c->cnt) {
+    start += c->cnt;
+    c = c->next;
+  }
+  L->cursor = c;
+  L->off = i - start;
+  L->idx = i;
+  d->cgroup = g;
+}
+
+void spliceList(List A, List B) {
+  if(A == B || B->head == NULL) return;
+  dirFree(A);
+  dirFree(B);
+  if(A->head == NULL) {
+    A->head = B->head;
+  } else {
+    A->tail->next = B->head;
+    B->head->pre = A->tail;
+  }
+  A->tail = B->tail;
+  A->cnt += B->cnt;
+  B->head = NULL;
+  B->tail = NULL;
+  B->cursor = NULL;
+  B->cnt = 0;
+  B->idx = -1;
+}
+
+#endif // LIST_UNROLLED
@@ -1,63 +1,319 @@
 #include "Graph.h"
 #include "List.h"
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
 
-int main(int argc, const char **argv) {
-  if(argc != 3) {
-    fprintf(stderr, "correct format should be: FindPath input_file output_file\n");
+// Queries are answered QUERY_WINDOW at a time: grouped by source inside the
+// window, then printed in input order, so only one window of answers is ever
+// held in memory.
+#define QUERY_WINDOW 4096
+
+// Default number of BFS trees kept by setBFSCache, lowered on big graphs so
+// the cache stays under CACHE_BYTES (every tree costs 12 * (n + 1) bytes).
+#define CACHE_TREES 16
+#define CACHE_BYTES (256LL << 20)
+
+typedef struct Query {
+  int u, v;
+  char *text; // formatted answer, filled in source order
+  size_t len, cap;
+}Query;
+
+static void queryf(Query *q, const char *fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int need = vsnprintf(NULL, 0, fmt, ap);
+  va_end(ap);
+  if(q->len + need + 1 > q->cap) {
+    q->cap = (q->len + need + 1) * 2;
+    q->text = (char*)realloc(q->text, q->cap);
+  }
+  va_start(ap, fmt);
+  vsnprintf(q->text + q->len, need + 1, fmt, ap);
+  va_end(ap);
+  q->len += need;
+}
+
+// Formats the answer for q from its distance and path.
+static void answer(Query *q, int dis, List path) {
+  int u = q->u, v = q->v;
+  queryf(q, "\n");
+  if(dis == INF) {
+    queryf(q, "The distance from %d to %d is infinity\n", u, v);
+    queryf(q, "No %d-%d path exists\n", u, v);
+  } else {
+    queryf(q, "The distance from %d to %d is %d\n", u, v, dis);
+    queryf(q, "A shortest %d-%d path is:", u, v);
+    moveFront(path);
+    while(index(path) >=0) {
+      queryf(q, " %d", get(path));
+      moveNext(path);
+    }
+    queryf(q, "\n");
+  }
+}
+
+static Query *queries;
+
+// Buffered integer reader, far cheaper than one fscanf per number.
+typedef struct Reader {
+  FILE *in;
+  size_t pos, len;
+  char buf[1 << 16];
+}Reader;
+
+static int readByte(Reader *rd) {
+  if(rd->pos == rd->len) {
+    rd->len = fread(rd->buf, 1, sizeof(rd->buf), rd->in);
+    rd->pos = 0;
+    if(rd->len == 0) return EOF;
+  }
+  return (unsigned char)rd->buf[rd->pos++];
+}
+
+// Reads the next (optionally negative) decimal integer, false at the end of
+// the input.
+static bool readInt(Reader *rd, int *x) {
+  int c = readByte(rd);
+  while(c != EOF && c != '-' && (c < '0' || c > '9')) {
+    c = readByte(rd);
+  }
+  if(c == EOF) return false;
+  bool neg = (c == '-');
+  if(neg) c = readByte(rd);
+  long long val = 0;
+  while(c >= '0' && c <= '9') {
+    if(val < 0x80000000LL) val = val * 10 + (c - '0');
+    c = readByte(rd);
+  }
+  if(val > 0x7fffffff) val = 0x7fffffff;
+  *x = (int)(neg ? -val : val);
+  return true;
+}
+
+// Reads the vertex count and the edge section, and builds the adjacency
+// once.
+static Graph readGraph(Reader *rd, const char *name) {
+  int n;
+  if(!readInt(rd, &n) || n < 0) {
+    fprintf(stderr, "missing vertex count in %s\n", name);
     exit(1);
   }
-  FILE *in = fopen(argv[1], "r");
+  Graph g = newGraph(n);
+  int m = 0, ecap = 1024;
+  int *U = (int*)malloc(sizeof(int) * ecap), *V = (int*)malloc(sizeof(int) * ecap);
+  int u, v;
+  while(readInt(rd, &u) && readInt(rd, &v) && !(u == 0 && v == 0)) {
+    if(m == ecap) {
+      ecap *= 2;
+      U = (int*)realloc(U, sizeof(int) * ecap);
+      V = (int*)realloc(V, sizeof(int) * ecap);
+    }
+    U[m] = u;
+    V[m] = v;
+    m++;
+  }
+  loadEdges(g, U, V, m, false);
+  free(U);
+  free(V);
+  return g;
+}
+
+// Answers the queries order[0..nq) (sorted by source) with multiBFS, 64
+// distinct sources per pass.
+static void answerMulti(Graph g, const int *order, int nq, List path) {
+  int n = getOrder(g);
+  int *D = (int*)malloc(sizeof(int) * 64 * (size_t)(n + 1));
+  int S[64];
+  for(int i = 0; i < nq;) {
+    int k = 0, j = i;
+    while(j < nq && (k < 64 || queries[order[j]].u == S[k - 1])) {
+      if(k == 0 || queries[order[j]].u != S[k - 1]) S[k++] = queries[order[j]].u;
+      j++;
+    }
+    multiBFS(g, S, k, D);
+    for(int r = 0; i < j; i++) {
+      Query *q = &queries[order[i]];
+      while(S[r] != q->u) r++;
+      const int *dist = D + (size_t)r * (n + 1);
+      clear(path);
+      getDistPath(path, g, dist, q->v);
+      answer(q, dist[q->v], path);
+    }
+  }
+  free(D);
+}
+
+// by source, then by input position
+static int bySource(const void *a, const void *b) {
+  int x = *(const int*)a, y = *(const int*)b;
+  if(queries[x].u != queries[y].u) return queries[x].u < queries[y].u ? -1 : 1;
+  return (x > y) - (x < y);
+}
+
+static void usage(void) {
+  fprintf(stderr, "correct format should be: FindPath [-e queue|hybrid|parallel|bitmap|pair|multi] [-t threads] [-k trees] [-r rcm|bfs|degree] [-c] [-g graph.bin | -w graph.bin] input_file output_file\n");
+  exit(1);
+}
+
+int main(int argc, const char **argv) {
+  int mode = BFS_QUEUE;
+  bool pair = false; // answer each query with a bidirectional search
+  bool multi = false; // distances from 64 sources per pass
+  int threads = 1;
+  int cacheTrees = -1; // -1 picks the default from the graph size
+  int reorder = -1;
+  bool compress = false;
+  const char *graphPath = NULL; // binary graph, the input then only has queries
+  const char *savePath = NULL;
+  int argi = 1;
+  while(argi < argc && argv[argi][0] == '-' && argv[argi][1] != 0) {
+    if(strcmp(argv[argi], "-e") == 0 && argi + 1 < argc) {
+      if(strcmp(argv[argi + 1], "queue") == 0) {
+        mode = BFS_QUEUE;
+      } else if(strcmp(argv[argi + 1], "hybrid") == 0) {
+        mode = BFS_HYBRID;
+      } else if(strcmp(argv[argi + 1], "parallel") == 0) {
+        mode = BFS_PARALLEL;
+      } else if(strcmp(argv[argi + 1], "bitmap") == 0) {
+        mode = BFS_BITMAP;
+      } else if(strcmp(argv[argi + 1], "multi") == 0) {
+        multi = true;
+      } else if(strcmp(argv[argi + 1], "pair") == 0) {
+        pair = true;
+      } else {
+        fprintf(stderr, "unknown BFS engine %s\n", argv[argi + 1]);
+        exit(1);
+      }
+      argi += 2;
+    } else if(strcmp(argv[argi], "-g") == 0 && argi + 1 < argc) {
+      graphPath = argv[argi + 1];
+      argi += 2;
+    } else if(strcmp(argv[argi], "-w") == 0 && argi + 1 < argc) {
+      savePath = argv[argi + 1];
+      argi += 2;
+    } else if(strcmp(argv[argi], "-c") == 0) {
+      compress = true;
+      argi += 1;
+    } else if(strcmp(argv[argi], "-r") == 0 && argi + 1 < argc) {
+      if(strcmp(argv[argi + 1], "rcm") == 0) {
+        reorder = ORDER_RCM;
+      } else if(strcmp(argv[argi + 1], "bfs") == 0) {
+        reorder = ORDER_BFS;
+      } else if(strcmp(argv[argi + 1], "degree") == 0) {
+        reorder = ORDER_DEGREE;
+      } else {
+        fprintf(stderr, "unknown vertex order %s\n", argv[argi + 1]);
+        exit(1);
+      }
+      argi += 2;
+    } else if(strcmp(argv[argi], "-t") == 0 && argi + 1 < argc) {
+      char *end;
+      long t = strtol(argv[argi + 1], &end, 10);
+      if(end == argv[argi + 1] || *end != 0 || t < 0 || t > 1024) {
+        fprintf(stderr, "invalid thread count %s\n", argv[argi + 1]);
+        exit(1);
+      }
+      // 0 means one thread per online core
+      threads = (t == 0) ? (int)sysconf(_SC_NPROCESSORS_ONLN) : (int)t;
+      if(threads < 1) threads = 1;
+      argi += 2;
+    } else if(strcmp(argv[argi], "-k") == 0 && argi + 1 < argc) {
+      char *end;
+      long k = strtol(argv[argi + 1], &end, 10);
+      if(end == argv[argi + 1] || *end != 0 || k < 0 || k > 4096) {
+        fprintf(stderr, "invalid cache size %s\n", argv[argi + 1]);
+        exit(1);
+      }
+      cacheTrees = (int)k;
+      argi += 2;
+    } else {
+      usage();
+    }
+  }
+  if(argc - argi != 2) usage();
+  FILE *in = fopen(argv[argi], "r");
   if(in == NULL) {
-    fprintf(stderr, "failed to open file %s\n", argv[1]);
+    fprintf(stderr, "failed to open file %s\n", argv[argi]);
     exit(1);
   }
-  FILE *out = fopen(argv[2], "w");
+  FILE *out = fopen(argv[argi + 1], "w");
   if(out == NULL) {
-    fprintf(stderr, "failed to write file %s\n", argv[2]);
+    fprintf(stderr, "failed to write file %s\n", argv[argi + 1]);
     exit(2);
   }
-  int n;
-  fscanf(in, "%d", &n);
-  Graph g = newGraph(n);
+  Reader *rd = (Reader*)calloc(1, sizeof(Reader));
+  rd->in = in;
+  Graph g = (graphPath != NULL) ? loadGraph(graphPath) : readGraph(rd, argv[argi]);
+  int n = getOrder(g);
+  setBFSMode(g, mode);
+  setBFSThreads(g, threads);
+  if(reorder >= 0) reorderGraph(g, reorder);
+  if(savePath != NULL) saveGraph(g, savePath);
+  if(compress) compressGraph(g);
+  if(!pair && !multi) {
+    // repeated sources, also across windows, swap their tree back in
+    if(cacheTrees < 0) {
+      long long fit = CACHE_BYTES / (12LL * (n + 1));
+      cacheTrees = (fit < CACHE_TREES) ? (int)fit : CACHE_TREES;
+    }
+    setBFSCache(g, cacheTrees);
+  }
+  printGraph(out, g);
+
   int u, v;
-  int swo = 0;
-  while(!feof(in)) {
-    fscanf(in, "%d%d", &u, &v);
-    if(u == 0 && v == 0) {
-      swo++;
-      if(swo == 1) {
-        printGraph(out, g);
-        continue;
+  queries = (Query*)calloc(1, sizeof(Query) * QUERY_WINDOW);
+  int *order = (int*)malloc(sizeof(int) * QUERY_WINDOW);
+  List path = newList();
+  int last = NIL; // source of the current BFS tree, kept across windows
+  bool more = true;
+  while(more) {
+    int nq = 0;
+    while(nq < QUERY_WINDOW && (more = readInt(rd, &u) && readInt(rd, &v) && !(u == 0 && v == 0))) {
+      if(u > n || u < 1 || v > n || v < 1) {
+        fprintf(stderr, "query %d %d: vertices must be in 1..%d\n", u, v, n);
+        exit(1);
       }
-      if(swo == 2) break;
+      queries[nq].u = u;
+      queries[nq].v = v;
+      nq++;
     }
-    if(swo == 0) {
-      addEdge(g, u, v);
-    } else if(swo == 1) {
-      fprintf(out, "\n");
-      List path = newList();
-      BFS(g, u);
-      getPath(path, g, v);
-      int dis = getDist(g, v);
-      if(dis == INF) {
-        fprintf(out, "The distance from %d to %d is infinity\n", u, v);
-        fprintf(out, "No %d-%d path exists\n", u, v);
-      } else {
-        fprintf(out, "The distance from %d to %d is %d\n", u, v, dis);
-        fprintf(out, "A shortest %d-%d path is:", u, v);
-        moveFront(path);
-        while(index(path) >=0) {
-          fprintf(out, " %d", get(path));
-          moveNext(path);
-        }
-        fprintf(out, "\n");
+    // answer every query of a source in the window from one BFS tree, then
+    // print the window in input order
+    for(int i = 0; i < nq; i++) {
+      order[i] = i;
+    }
+    if(!pair) qsort(order, nq, sizeof(int), bySource);
+    if(multi) answerMulti(g, order, nq, path);
+    for(int i = 0; i < nq && !multi; i++) {
+      Query *q = &queries[order[i]];
+      clear(path);
+      if(pair) {
+        answer(q, pairBFS(path, g, q->u, q->v), path);
+        continue;
+      }
+      if(q->u != last) {
+        BFS(g, q->u);
+        last = q->u;
       }
-     
-      freeList(&path);
-    } 
+      getPath(path, g, q->v);
+      answer(q, getDist(g, q->v), path);
+    }
+    for(int i = 0; i < nq; i++) {
+      fwrite(queries[i].text, 1, queries[i].len, out);
+      queries[i].len = 0;
+    }
+  }
+  for(int i = 0; i < QUERY_WINDOW; i++) {
+    free(queries[i].text);
   }
+  freeList(&path);
+  free(order);
+  free(queries);
+  free(rd);
   fclose(in);
   fclose(out);
   freeGraph(&g);
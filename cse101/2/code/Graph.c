@@ -1,37 +1,114 @@
 #include "Graph.h"
 #include "List.h"
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <memory.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-Graph newGraph(int n) {
+// Internal id of caller vertex u, and back (see reorderGraph()).
+static inline int inner(Graph G, int u) {
+  return (G->toNew != NULL) ? G->toNew[u] : u;
+}
+
+static inline int outer(Graph G, int x) {
+  return (G->toOld != NULL) ? G->toOld[x] : x;
+}
+
+// Gives G a fresh empty adjacency List per vertex.
+static void newAdjLists(Graph G) {
+  G->adj = (List*)calloc(1, sizeof(List) * (G->order + 1));
+  for(int i = 0; i <= G->order; i++) {
+    G->adj[i] = newList();
+  }
+}
+
+// Drops the CSR arrays, unmapping them if they came from loadGraph().
+static void freeCSR(Graph G) {
+  if(G->map != NULL) {
+    munmap(G->map, G->mapLen);
+    G->map = NULL;
+    G->mapLen = 0;
+  } else {
+    free(G->off);
+    free(G->nbr);
+  }
+  free(G->roff);
+  free(G->rnbr);
+  free(G->pack);
+  free(G->packOff);
+  G->off = NULL;
+  G->nbr = NULL;
+  G->pack = NULL;
+  G->packOff = NULL;
+  G->roff = NULL;
+  G->rnbr = NULL;
+}
+
+// A graph of n vertices with its BFS arrays but no adjacency yet.
+static Graph allocGraph(int n) {
   if(n < 0) {
     fprintf(stderr, "node size must >= 0\n");
     exit(1);
   }
   Graph graph = (Graph)calloc(1, sizeof(GraphObj));
   graph->order = n;
+  graph->threads = 1;
   n += 1;
   graph->color = (int*)calloc(1, sizeof(int) * n);
   graph->parent = (int*)calloc(1, sizeof(int) * n);
   graph->distance = (int*)calloc(1, sizeof(int) * n);
   memset(graph->distance, 0x80, sizeof(int) * (graph->order + 1));
-  graph->adj = (List*)calloc(1, sizeof(List) * n);
-  for(int i = 0; i < n; i++) {
-    graph->adj[i] = newList();
-  }
   return graph;
 }
 
+Graph newGraph(int n) {
+  Graph graph = allocGraph(n);
+  newAdjLists(graph);
+  return graph;
+}
+
+// Drops the adjacency lists (the CSR arrays must hold the edges by now).
+static void freeAdjLists(Graph G) {
+  for(int i = 0; i <= G->order; i++) {
+    freeList(&G->adj[i]);
+  }
+  free(G->adj);
+  G->adj = NULL;
+}
+
+// Rebuilds the adjacency lists from the CSR arrays and frees them.
+static void thawGraph(Graph G) {
+  freezeGraph(G);
+  newAdjLists(G);
+  for(int u = 1; u <= G->order; u++) {
+    for(int k = G->off[u]; k < G->off[u + 1]; k++) {
+      append(G->adj[u], G->nbr[k]);
+    }
+  }
+  freeCSR(G);
+}
+
 void freeGraph(Graph* pG) {
-  for(int i = 0; i <= (*pG)->order ; i++) {
-    freeList(&(*pG)->adj[i]);
+  if(isFrozen(*pG)) {
+    freeCSR(*pG);
+  } else {
+    freeAdjLists(*pG);
   }
   free((*pG)->color);
   free((*pG)->parent);
   free((*pG)->distance);
-  free((*pG)->adj);
+  setBFSCache(*pG, 0);
+  free((*pG)->pairMark);
+  free((*pG)->pairPar);
+  free((*pG)->pairQueue);
+  free((*pG)->toNew);
+  free((*pG)->toOld);
   free(*pG);
   (*pG) = NULL;
 }
@@ -46,7 +123,7 @@ int getSize(Graph G) {
 }
 
 int getSource(Graph G) {
-  return G->source;
+  return outer(G, G->source);
 }
 
 int getParent(Graph G, int u) {
@@ -54,7 +131,7 @@ int getParent(Graph G, int u) {
     fprintf(stderr, "%s error: u must meet 1 <= u <= getOrder(G) ", __func__);
     exit(1);
   }
-  return G->parent[u];
+  return outer(G, G->parent[inner(G, u)]);
 }
 
 int getDist(Graph G, int u) {
@@ -62,7 +139,7 @@ int getDist(Graph G, int u) {
     fprintf(stderr, "%s error: u must meet 1 <= u <= getOrder(G) ", __func__);
     exit(1);
   }
-  return G->distance[u];
+  return G->distance[inner(G, u)];
 }
 
 void getPath(List L, Graph G, int u) {
@@ -79,36 +156,51 @@ void getPath(List L, Graph G, int u) {
     exit(1);
   }
 
-  if(G->distance[u] == INF) {
+  int x = inner(G, u);
+  if(G->distance[x] == INF) {
     append(L, NIL);
     return;
   }
-  // for(int i = 0; i <= G->order; i++) {
-  //   printf("%d: %d  %d->%d\n", i, G->distance[i], G->parent[i], i);
-  // }
-  // printf("s: %d u: %d dis: %d\n", G->source , u, G->distance[u]);
   append(L, u);
-  if(G->source == u) return;
-  do {
-    prepend(L, G->parent[u]);
-    u = G->parent[u];
-  } while(u != G->source);
+  while(x != G->source) {
+    x = G->parent[x];
+    prepend(L, outer(G, x));
+  }
 }
 
 /*** Manipulation procedures ***/
+// Forgets every BFS result, the edges are about to change.
+static void invalidateBFS(Graph G) {
+  G->fresh = false;
+  for(int i = 0; i < G->cacheCap; i++) {
+    G->cache[i].source = NIL;
+  }
+}
+
 void makeNull(Graph G) {
+  if(isFrozen(G)) {
+    freeCSR(G);
+    newAdjLists(G);
+  }
   for(int i = 0; i <= G->order; i++) {
-    freeList(&G->adj[i]);
+    clear(G->adj[i]);
   }
-  G->order = 0;
   G->source = 0;
   G->size = 0;
+  G->directed = false;
+  free(G->toNew);
+  free(G->toOld);
+  G->toNew = NULL;
+  G->toOld = NULL;
+  invalidateBFS(G);
   memset(G->color, 0, sizeof(int) * (G->order + 1));
   memset(G->distance, 0x80, sizeof(int) * (G->order + 1));
   memset(G->parent, 0, sizeof(int) * (G->order + 1));
 }
 
 void addHelp(Graph G, int u, int v) {
+  invalidateBFS(G);
+  if(isFrozen(G)) thawGraph(G);
   List lu = G->adj[u];
   moveFront(lu);
   if(index(lu) < 0) {
@@ -128,14 +220,63 @@ void addHelp(Graph G, int u, int v) {
   insertBefore(lu, v);
 }
 
+// Incremental repairs give up past order / INCR_SHARE changed vertices.
+#define INCR_SHARE 8
+
+// Lowers distances after the new arc u -> v of a fresh BFS tree: v and
+// everything it now reaches sooner are relaxed in BFS order, each vertex at
+// most once. Returns false once the repair grows too large.
+static bool relaxArc(Graph G, int u, int v) {
+  int d = G->distance[u];
+  if(d == INF || (G->distance[v] != INF && G->distance[v] <= d + 1)) return true;
+  int limit = G->order / INCR_SHARE + 1, head = 0, tail = 0;
+  int *queue = (int*)malloc(sizeof(int) * limit);
+  G->distance[v] = d + 1;
+  G->parent[v] = u;
+  G->color[v] = BLACK;
+  queue[tail++] = v;
+  while(head < tail) {
+    int x = queue[head++];
+    List lx = G->adj[x];
+    for(moveFront(lx); index(lx) >= 0; moveNext(lx)) {
+      int y = get(lx);
+      if(G->distance[y] != INF && G->distance[y] <= G->distance[x] + 1) continue;
+      if(tail == limit) {
+        free(queue);
+        return false;
+      }
+      G->distance[y] = G->distance[x] + 1;
+      G->parent[y] = x;
+      G->color[y] = BLACK;
+      queue[tail++] = y;
+    }
+  }
+  free(queue);
+  return true;
+}
+
+// Brings the BFS tree back in line after u -> v (and v -> u unless
+// directed) was added, or searches again from the source.
+static void repairBFS(Graph G, int u, int v, bool directed) {
+  if(relaxArc(G, u, v) && (directed || relaxArc(G, v, u))) {
+    G->fresh = true;
+    return;
+  }
+  BFS(G, outer(G, G->source));
+}
+
 void addEdge(Graph G, int u, int v) {
   if(u > G->order || u < 1 || v > G->order || v < 1) {
     fprintf(stderr, "%s error: u or v must meet 1 <= u <= getOrder(G) ", __func__);
     exit(1);
   }
+  u = inner(G, u);
+  v = inner(G, v);
+  bool live = G->incremental && G->fresh;
   addHelp(G, u, v);
   addHelp(G, v, u);
   G->size += 1;
+  if(live) repairBFS(G, u, v, false);
 }
 
 void addArc(Graph G, int u, int v) {
@@ -143,11 +284,760 @@ void addArc(Graph G, int u, int v) {
     fprintf(stderr, "%s error: u or v must meet 1 <= u <= getOrder(G) ", __func__);
     exit(1);
   }
-  addHelp(G, u, v);
+  bool live = G->incremental && G->fresh;
+  addHelp(G, inner(G, u), inner(G, v));
   G->size += 1;
+  G->directed = true;
+  if(live) repairBFS(G, inner(G, u), inner(G, v), true);
+}
+
+bool isFrozen(Graph G) {
+  return G->adj == NULL;
+}
+
+// One varint: 7 bits per byte, low bits first, high bit set on all but the
+// last byte.
+static inline unsigned readVarint(const unsigned char **p) {
+  const unsigned char *q = *p;
+  unsigned v = q[0];
+  if(v < 0x80) {
+    *p = q + 1;
+    return v;
+  }
+  v = (v & 0x7f) | (unsigned)q[1] << 7;
+  if(q[1] < 0x80) {
+    *p = q + 2;
+    return v;
+  }
+  v = (v & 0x3fff) | (unsigned)q[2] << 14;
+  if(q[2] < 0x80) {
+    *p = q + 3;
+    return v;
+  }
+  v = (v & 0x1fffff) | (unsigned)q[3] << 21;
+  if(q[3] < 0x80) {
+    *p = q + 4;
+    return v;
+  }
+  *p = q + 5;
+  return (v & 0xfffffff) | (unsigned)q[4] << 28;
+}
+
+// The first gap of a row may be negative: 0, -1, 1, -2 .. map to 0, 1, 2, 3 ..
+static inline int unzigzag(unsigned z) {
+  return (int)((z >> 1) ^ (0u - (z & 1)));
+}
+
+static inline int writeVarint(unsigned char *p, unsigned v) {
+  int len = 0;
+  while(v >= 0x80) {
+    if(p != NULL) p[len] = (unsigned char)(v | 0x80);
+    v >>= 7;
+    len++;
+  }
+  if(p != NULL) p[len] = (unsigned char)v;
+  return len + 1;
+}
+
+// Encodes the row of u (sorted) at p, or only measures it when p is NULL.
+static size_t packRow(const int *row, int d, int u, unsigned char *p) {
+  size_t len = 0;
+  int prev = u;
+  for(int k = 0; k < d; k++) {
+    int gap = row[k] - prev;
+    unsigned v = (unsigned)gap;
+    if(k == 0) {
+      v = ((unsigned)gap << 1) ^ (unsigned)(gap >> 31);
+    } else if(gap < 0) {
+      fprintf(stderr, "%s error: row %d is not sorted\n", __func__, u);
+      exit(1);
+    }
+    len += writeVarint(p != NULL ? p + len : NULL, v);
+    prev = row[k];
+  }
+  return len;
+}
+
+// Decodes the row of u into row, returns its length.
+static int unpackRow(Graph G, int u, int *row) {
+  const unsigned char *p = G->pack + G->packOff[u];
+  const unsigned char *end = G->pack + G->packOff[u + 1];
+  int d = 0;
+  if(p == end) return 0;
+  int x = u + unzigzag(readVarint(&p));
+  row[d++] = x;
+  while(p < end) {
+    x += (int)readVarint(&p);
+    row[d++] = x;
+  }
+  return d;
+}
+
+// Number of arcs in the compressed row of u: every varint ends in a byte
+// below 0x80.
+static int packDegree(Graph G, int u) {
+  int d = 0;
+  for(size_t k = G->packOff[u]; k < G->packOff[u + 1]; k++) {
+    d += G->pack[k] < 0x80;
+  }
+  return d;
+}
+
+// Turns a compressed graph back into the CSR arrays.
+static void unpackGraph(Graph G) {
+  int n = G->order, arcs = 0;
+  for(int u = 1; u <= n; u++) {
+    arcs += packDegree(G, u);
+  }
+  int *off = (int*)calloc(1, sizeof(int) * (n + 2));
+  int *nbr = (int*)calloc(1, sizeof(int) * (arcs > 0 ? arcs : 1));
+  for(int u = 1; u <= n; u++) {
+    off[u + 1] = off[u] + unpackRow(G, u, nbr + off[u]);
+  }
+  freeCSR(G);
+  G->off = off;
+  G->nbr = nbr;
+}
+
+bool isCompressed(Graph G) {
+  return G->pack != NULL;
+}
+
+void compressGraph(Graph G) {
+  if(isCompressed(G)) return;
+  freezeGraph(G);
+  int n = G->order;
+  size_t *packOff = (size_t*)calloc(1, sizeof(size_t) * (n + 2));
+  for(int u = 1; u <= n; u++) {
+    packOff[u + 1] = packOff[u] + packRow(G->nbr + G->off[u], G->off[u + 1] - G->off[u], u, NULL);
+  }
+  unsigned char *pack = (unsigned char*)malloc(packOff[n + 1] > 0 ? packOff[n + 1] : 1);
+  for(int u = 1; u <= n; u++) {
+    packRow(G->nbr + G->off[u], G->off[u + 1] - G->off[u], u, pack + packOff[u]);
+  }
+  freeCSR(G);
+  G->pack = pack;
+  G->packOff = packOff;
+}
+
+void freezeGraph(Graph G) {
+  if(isCompressed(G)) unpackGraph(G);
+  if(isFrozen(G)) return;
+  int arcs = 0;
+  for(int u = 1; u <= G->order; u++) {
+    arcs += length(G->adj[u]);
+  }
+  G->off = (int*)calloc(1, sizeof(int) * (G->order + 2));
+  G->nbr = (int*)calloc(1, sizeof(int) * (arcs > 0 ? arcs : 1));
+  int k = 0;
+  for(int u = 1; u <= G->order; u++) {
+    G->off[u] = k;
+    List lu = G->adj[u];
+    for(moveFront(lu); index(lu) >= 0; moveNext(lu)) {
+      G->nbr[k++] = get(lu);
+    }
+  }
+  G->off[G->order + 1] = k;
+  freeAdjLists(G);
+}
+
+static int compareInt(const void *a, const void *b) {
+  int x = *(const int*)a, y = *(const int*)b;
+  return (x > y) - (x < y);
+}
+
+static void sortRow(int *a, int n) {
+  if(n > 32) {
+    qsort(a, n, sizeof(int), compareInt);
+    return;
+  }
+  for(int i = 1; i < n; i++) {
+    int x = a[i], j = i;
+    while(j > 0 && a[j - 1] > x) {
+      a[j] = a[j - 1];
+      j--;
+    }
+    a[j] = x;
+  }
+}
+
+static long long countLoops(Graph G) {
+  long long loops = 0;
+  for(int u = 1; u <= G->order; u++) {
+    for(int k = G->off[u]; k < G->off[u + 1]; k++) {
+      loops += (G->nbr[k] == u);
+    }
+  }
+  return loops;
+}
+
+void loadEdges(Graph G, const int *U, const int *V, int m, bool directed) {
+  for(int i = 0; i < m; i++) {
+    if(U[i] > G->order || U[i] < 1 || V[i] > G->order || V[i] < 1) {
+      fprintf(stderr, "%s error: u or v must meet 1 <= u <= getOrder(G)\n", __func__);
+      exit(1);
+    }
+  }
+  invalidateBFS(G);
+  freezeGraph(G);
+  int *tU = NULL, *tV = NULL;
+  if(G->toNew != NULL) {
+    tU = (int*)malloc(sizeof(int) * (m > 0 ? m : 1));
+    tV = (int*)malloc(sizeof(int) * (m > 0 ? m : 1));
+    for(int i = 0; i < m; i++) {
+      tU[i] = G->toNew[U[i]];
+      tV[i] = G->toNew[V[i]];
+    }
+    U = tU;
+    V = tV;
+  }
+  int n = G->order;
+  long long oldArcs = G->off[n + 1], oldLoops = directed ? 0 : countLoops(G);
+  long long arcs = oldArcs + (directed ? m : 2LL * m);
+  if(arcs > 0x7fffffff) {
+    fprintf(stderr, "%s error: too many arcs\n", __func__);
+    exit(1);
+  }
+  // bucket the old and the new arcs by tail, counting sort style
+  int *off = (int*)calloc(1, sizeof(int) * (n + 2));
+  for(int u = 1; u <= n; u++) {
+    off[u + 1] = G->off[u + 1] - G->off[u];
+  }
+  for(int i = 0; i < m; i++) {
+    off[U[i] + 1] += 1;
+    if(!directed) off[V[i] + 1] += 1;
+  }
+  for(int u = 1; u <= n + 1; u++) {
+    off[u] += off[u - 1];
+  }
+  int *nbr = (int*)malloc(sizeof(int) * (arcs > 0 ? arcs : 1));
+  int *fill = (int*)malloc(sizeof(int) * (n + 1));
+  for(int u = 1; u <= n; u++) {
+    int d = G->off[u + 1] - G->off[u];
+    memcpy(nbr + off[u], G->nbr + G->off[u], sizeof(int) * d);
+    fill[u] = off[u] + d;
+  }
+  for(int i = 0; i < m; i++) {
+    nbr[fill[U[i]]++] = V[i];
+    if(!directed) nbr[fill[V[i]]++] = U[i];
+  }
+  free(fill);
+  // sort each row once and squeeze out repeated neighbors in place
+  int k = 0;
+  for(int u = 1; u <= n; u++) {
+    int b = off[u], e = off[u + 1];
+    sortRow(nbr + b, e - b);
+    off[u] = k;
+    for(int i = b; i < e; i++) {
+      if(i == b || nbr[i] != nbr[i - 1]) nbr[k++] = nbr[i];
+    }
+  }
+  off[n + 1] = k;
+  freeCSR(G);
+  G->off = off;
+  G->nbr = (int*)realloc(nbr, sizeof(int) * (k > 0 ? k : 1));
+  if(directed) {
+    G->size += k - oldArcs;
+    G->directed = true;
+  } else {
+    // an undirected edge is two arcs, a self loop only one
+    G->size += (k - oldArcs + countLoops(G) - oldLoops) / 2;
+  }
+  free(tU);
+  free(tV);
+}
+
+// BFS over the CSR arrays with an array queue. Each vertex is queued once,
+// when it turns GRAY, so parents and distances match the list version.
+static void csrBFS(Graph G, int s) {
+  int *queue = (int*)malloc(sizeof(int) * (G->order + 1));
+  int head = 0, tail = 0;
+  queue[tail++] = s;
+  G->color[s] = GRAY;
+  G->distance[s] = 0;
+  while(head < tail) {
+    int cur = queue[head++];
+    int d = G->distance[cur] + 1;
+    for(int k = G->off[cur]; k < G->off[cur + 1]; k++) {
+      int x = G->nbr[k];
+      if(G->color[x] == WHITE) {
+        G->color[x] = GRAY;
+        G->parent[x] = cur;
+        G->distance[x] = d;
+        queue[tail++] = x;
+      }
+    }
+    G->color[cur] = BLACK;
+  }
+  free(queue);
+}
+
+// csrBFS over a compressed graph, decoding every row as it is scanned.
+static void packedBFS(Graph G, int s) {
+  int *queue = (int*)malloc(sizeof(int) * (G->order + 1));
+  int head = 0, tail = 0;
+  queue[tail++] = s;
+  G->color[s] = GRAY;
+  G->distance[s] = 0;
+  while(head < tail) {
+    int cur = queue[head++];
+    int d = G->distance[cur] + 1;
+    const unsigned char *p = G->pack + G->packOff[cur];
+    const unsigned char *end = G->pack + G->packOff[cur + 1];
+    if(p == end) {
+      G->color[cur] = BLACK;
+      continue;
+    }
+    int x = cur + unzigzag(readVarint(&p));
+    while(true) {
+      if(G->color[x] == WHITE) {
+        G->color[x] = GRAY;
+        G->parent[x] = cur;
+        G->distance[x] = d;
+        queue[tail++] = x;
+      }
+      if(p == end) break;
+      x += (int)readVarint(&p);
+    }
+    G->color[cur] = BLACK;
+  }
+  free(queue);
+}
+
+// Builds the in-neighbor CSR of a frozen directed graph (counting sort of
+// the arcs by head, so every in-list comes out sorted too).
+static void buildReverse(Graph G) {
+  int n = G->order, arcs = G->off[n + 1];
+  G->roff = (int*)calloc(1, sizeof(int) * (n + 2));
+  G->rnbr = (int*)calloc(1, sizeof(int) * (arcs > 0 ? arcs : 1));
+  for(int k = 0; k < arcs; k++) {
+    G->roff[G->nbr[k] + 1] += 1;
+  }
+  for(int v = 1; v <= n + 1; v++) {
+    G->roff[v] += G->roff[v - 1];
+  }
+  int *fill = (int*)malloc(sizeof(int) * (n + 1));
+  memcpy(fill, G->roff, sizeof(int) * (n + 1));
+  for(int u = 1; u <= n; u++) {
+    for(int k = G->off[u]; k < G->off[u + 1]; k++) {
+      G->rnbr[fill[G->nbr[k]]++] = u;
+    }
+  }
+  free(fill);
+}
+
+// One top-down step: every WHITE neighbor of front[0..nf) gets distance d and
+// is added to next. Returns the size of next.
+static int expandLevel(Graph G, const int *front, int nf, int *next, int d) {
+  int nn = 0;
+  for(int i = 0; i < nf; i++) {
+    int cur = front[i];
+    for(int k = G->off[cur]; k < G->off[cur + 1]; k++) {
+      int x = G->nbr[k];
+      if(G->color[x] == WHITE) {
+        G->color[x] = GRAY;
+        G->parent[x] = cur;
+        G->distance[x] = d;
+        next[nn++] = x;
+      }
+    }
+  }
+  return nn;
+}
+
+// Switch to bottom-up once the frontier's arcs outweigh the unexplored
+// arcs / ALPHA, and back to top-down once the frontier shrinks below n / BETA.
+#define HYBRID_ALPHA 14
+#define HYBRID_BETA 24
+
+// Direction-optimizing BFS (Beamer et al.). Top-down steps expand the
+// frontier like csrBFS; bottom-up steps let every WHITE vertex look for any
+// parent in the frontier and stop at the first one, which skips most of the
+// edge checks on the big middle levels of a low-diameter graph.
+static void hybridBFS(Graph G, int s) {
+  int n = G->order;
+  if(G->directed && G->roff == NULL) buildReverse(G);
+  const int *inOff = G->directed ? G->roff : G->off;
+  const int *inNbr = G->directed ? G->rnbr : G->nbr;
+  int *front = (int*)malloc(sizeof(int) * (n + 1));
+  int *next = (int*)malloc(sizeof(int) * (n + 1));
+  char *inFront = (char*)calloc(1, n + 1);
+  long long unexplored = G->off[n + 1];
+  int nf = 0, level = 0;
+  bool bottomUp = false;
+  front[nf++] = s;
+  G->color[s] = GRAY;
+  G->distance[s] = 0;
+  unexplored -= G->off[s + 1] - G->off[s];
+  while(nf > 0) {
+    long long frontArcs = 0;
+    for(int i = 0; i < nf; i++) {
+      frontArcs += G->off[front[i] + 1] - G->off[front[i]];
+    }
+    if(!bottomUp && frontArcs > unexplored / HYBRID_ALPHA) {
+      bottomUp = true;
+    } else if(bottomUp && nf < n / HYBRID_BETA) {
+      bottomUp = false;
+    }
+    int nn = 0, d = level + 1;
+    if(bottomUp) {
+      for(int i = 0; i < nf; i++) {
+        inFront[front[i]] = 1;
+      }
+      for(int v = 1; v <= n; v++) {
+        if(G->color[v] != WHITE) continue;
+        for(int k = inOff[v]; k < inOff[v + 1]; k++) {
+          int u = inNbr[k];
+          if(inFront[u]) {
+            G->color[v] = GRAY;
+            G->parent[v] = u;
+            G->distance[v] = d;
+            next[nn++] = v;
+            break;
+          }
+        }
+      }
+      for(int i = 0; i < nf; i++) {
+        inFront[front[i]] = 0;
+      }
+    } else {
+      nn = expandLevel(G, front, nf, next, d);
+    }
+    for(int i = 0; i < nf; i++) {
+      G->color[front[i]] = BLACK;
+    }
+    for(int i = 0; i < nn; i++) {
+      unexplored -= G->off[next[i] + 1] - G->off[next[i]];
+    }
+    int *t = front;
+    front = next;
+    next = t;
+    nf = nn;
+    level = d;
+  }
+  free(front);
+  free(next);
+  free(inFront);
+}
+
+// bitmapBFS keeps a frontier of more than order / BITMAP_DENSE vertices as
+// a bitmap
+#define BITMAP_DENSE 64
+
+static inline bool testBit(const uint64_t *b, int v) {
+  return (b[v >> 6] >> (v & 63)) & 1;
+}
+
+static inline void setBit(uint64_t *b, int v) {
+  b[v >> 6] |= 1ull << (v & 63);
+}
+
+// Level-synchronous BFS that tracks visited vertices in one bit each. A
+// small frontier is an array expanded top-down; a large one is a bitmap and
+// the level runs bottom-up, walking the unvisited vertices a 64-bit word at
+// a time and stopping at the first in-neighbor found in the frontier.
+static void bitmapBFS(Graph G, int s) {
+  int n = G->order, words = (n >> 6) + 1;
+  if(G->directed && G->roff == NULL) buildReverse(G);
+  const int *inOff = G->directed ? G->roff : G->off;
+  const int *inNbr = G->directed ? G->rnbr : G->nbr;
+  uint64_t *seen = (uint64_t*)calloc(1, sizeof(uint64_t) * words);
+  uint64_t *front = (uint64_t*)calloc(1, sizeof(uint64_t) * words);
+  uint64_t *next = (uint64_t*)calloc(1, sizeof(uint64_t) * words);
+  int *queue = (int*)malloc(sizeof(int) * (n + 1));
+  int *out = (int*)malloc(sizeof(int) * (n + 1));
+  // vertex 0 and the bits past n never get visited
+  setBit(seen, 0);
+  for(int v = n + 1; v < words * 64; v++) {
+    setBit(seen, v);
+  }
+  setBit(seen, s);
+  G->color[s] = BLACK;
+  G->distance[s] = 0;
+  queue[0] = s;
+  int nf = 1;
+  bool dense = false;
+  for(int d = 1; nf > 0; d++) {
+    int nn = 0;
+    if(dense) {
+      memset(next, 0, sizeof(uint64_t) * words);
+      for(int w = 0; w < words; w++) {
+        for(uint64_t todo = ~seen[w]; todo != 0; todo &= todo - 1) {
+          int v = (w << 6) + __builtin_ctzll(todo);
+          for(int k = inOff[v]; k < inOff[v + 1]; k++) {
+            if(testBit(front, inNbr[k])) {
+              G->color[v] = BLACK;
+              G->parent[v] = inNbr[k];
+              G->distance[v] = d;
+              setBit(next, v);
+              nn++;
+              break;
+            }
+          }
+        }
+        seen[w] |= next[w];
+      }
+    } else {
+      for(int i = 0; i < nf; i++) {
+        int cur = queue[i];
+        for(int k = G->off[cur]; k < G->off[cur + 1]; k++) {
+          int x = G->nbr[k];
+          if(testBit(seen, x)) continue;
+          setBit(seen, x);
+          G->color[x] = BLACK;
+          G->parent[x] = cur;
+          G->distance[x] = d;
+          out[nn++] = x;
+        }
+      }
+    }
+    // the next level in whichever form its size calls for
+    bool nextDense = nn > n / BITMAP_DENSE;
+    if(dense && nextDense) {
+      uint64_t *t = front;
+      front = next;
+      next = t;
+    } else if(dense) {
+      nn = 0;
+      for(int w = 0; w < words; w++) {
+        for(uint64_t b = next[w]; b != 0; b &= b - 1) {
+          queue[nn++] = (w << 6) + __builtin_ctzll(b);
+        }
+      }
+    } else if(nextDense) {
+      memset(front, 0, sizeof(uint64_t) * words);
+      for(int i = 0; i < nn; i++) {
+        setBit(front, out[i]);
+      }
+    } else {
+      int *t = queue;
+      queue = out;
+      out = t;
+    }
+    dense = nextDense;
+    nf = nn;
+  }
+  free(seen);
+  free(front);
+  free(next);
+  free(queue);
+  free(out);
+}
+
+// Levels smaller than this are expanded by the calling thread alone, so
+// thread start-up is only paid on levels big enough to split.
+#define PAR_MIN_FRONT 4096
+// frontier vertices a worker claims at a time
+#define PAR_CHUNK 256
+
+typedef struct LevelTask {
+  Graph G;
+  const int *front;
+  int nf;
+  int d;
+  int *claim; // next unclaimed frontier index, shared by the workers
+  int *buf;   // vertices this worker discovered on the level
+  int cnt, cap;
+}LevelTask;
+
+// Expands claimed chunks of the frontier. A vertex belongs to the worker
+// whose compare-and-swap turns it from WHITE to GRAY, so every vertex is
+// discovered once and its parent is a frontier vertex.
+static void *expandChunks(void *arg) {
+  LevelTask *t = (LevelTask*)arg;
+  Graph G = t->G;
+  t->cnt = 0;
+  for(;;) {
+    int i0 = __atomic_fetch_add(t->claim, PAR_CHUNK, __ATOMIC_RELAXED);
+    if(i0 >= t->nf) break;
+    int i1 = (i0 + PAR_CHUNK < t->nf) ? i0 + PAR_CHUNK : t->nf;
+    for(int i = i0; i < i1; i++) {
+      int cur = t->front[i];
+      for(int k = G->off[cur]; k < G->off[cur + 1]; k++) {
+        int x = G->nbr[k];
+        int white = WHITE;
+        if(__atomic_load_n(&G->color[x], __ATOMIC_RELAXED) != WHITE ||
+           !__atomic_compare_exchange_n(&G->color[x], &white, GRAY, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+          continue;
+        }
+        G->parent[x] = cur;
+        G->distance[x] = t->d;
+        if(t->cnt == t->cap) {
+          t->cap = t->cap ? t->cap * 2 : 1024;
+          t->buf = (int*)realloc(t->buf, sizeof(int) * t->cap);
+        }
+        t->buf[t->cnt++] = x;
+      }
+    }
+  }
+  return NULL;
+}
+
+static void runLevel(LevelTask *task, int n) {
+  pthread_t *tid = (pthread_t*)calloc(1, sizeof(pthread_t) * n);
+  for(int i = 0; i < n; i++) {
+    if(pthread_create(&tid[i], NULL, expandChunks, &task[i]) != 0) {
+      fprintf(stderr, "failed to create BFS thread\n");
+      exit(1);
+    }
+  }
+  for(int i = 0; i < n; i++) {
+    pthread_join(tid[i], NULL);
+  }
+  free(tid);
+}
+
+// Level-synchronous BFS that splits every large frontier across
+// G->threads workers and concatenates their discoveries into the next one.
+static void parallelBFS(Graph G, int s) {
+  int n = G->order, threads = G->threads;
+  int *front = (int*)malloc(sizeof(int) * (n + 1));
+  int *next = (int*)malloc(sizeof(int) * (n + 1));
+  LevelTask *task = (LevelTask*)calloc(1, sizeof(LevelTask) * threads);
+  int nf = 0, level = 0, claim = 0;
+  front[nf++] = s;
+  G->color[s] = GRAY;
+  G->distance[s] = 0;
+  while(nf > 0) {
+    int nn = 0, d = level + 1;
+    if(threads == 1 || nf < PAR_MIN_FRONT) {
+      nn = expandLevel(G, front, nf, next, d);
+    } else {
+      claim = 0;
+      for(int i = 0; i < threads; i++) {
+        task[i].G = G;
+        task[i].front = front;
+        task[i].nf = nf;
+        task[i].d = d;
+        task[i].claim = &claim;
+      }
+      runLevel(task, threads);
+      for(int i = 0; i < threads; i++) {
+        if(task[i].cnt == 0) continue;
+        memcpy(next + nn, task[i].buf, sizeof(int) * task[i].cnt);
+        nn += task[i].cnt;
+      }
+    }
+    for(int i = 0; i < nf; i++) {
+      G->color[front[i]] = BLACK;
+    }
+    int *t = front;
+    front = next;
+    next = t;
+    nf = nn;
+    level = d;
+  }
+  for(int i = 0; i < threads; i++) {
+    free(task[i].buf);
+  }
+  free(task);
+  free(front);
+  free(next);
+}
+
+void setBFSThreads(Graph G, int threads) {
+  if(threads < 1) {
+    fprintf(stderr, "%s error: thread count must >= 1\n", __func__);
+    exit(1);
+  }
+  G->threads = threads;
+}
+
+void setBFSMode(Graph G, int mode) {
+  if(mode != BFS_QUEUE && mode != BFS_HYBRID && mode != BFS_PARALLEL && mode != BFS_BITMAP) {
+    fprintf(stderr, "%s error: unknown BFS mode %d\n", __func__, mode);
+    exit(1);
+  }
+  G->mode = mode;
+}
+
+void setBFSIncremental(Graph G, bool on) {
+  G->incremental = on;
+}
+
+void setBFSCache(Graph G, int k) {
+  if(k < 0) {
+    fprintf(stderr, "%s error: cache size must >= 0\n", __func__);
+    exit(1);
+  }
+  for(int i = 0; i < G->cacheCap; i++) {
+    free(G->cache[i].color);
+    free(G->cache[i].parent);
+    free(G->cache[i].distance);
+  }
+  free(G->cache);
+  G->cache = NULL;
+  G->cacheCap = k;
+  if(k == 0) return;
+  G->cache = (BFSResult*)calloc(1, sizeof(BFSResult) * k);
+  for(int i = 0; i < k; i++) {
+    G->cache[i].color = (int*)calloc(1, sizeof(int) * (G->order + 1));
+    G->cache[i].parent = (int*)calloc(1, sizeof(int) * (G->order + 1));
+    G->cache[i].distance = (int*)calloc(1, sizeof(int) * (G->order + 1));
+  }
+}
+
+// Swaps the current result into a cache slot: the one holding s if there is
+// one (then G holds the result for s and true is returned), otherwise the
+// least recently used one, whose arrays G reuses for the new search.
+static bool cacheSwap(Graph G, int s) {
+  if(G->fresh && G->source == s) return true;
+  BFSResult *slot = &G->cache[0];
+  bool hit = false;
+  for(int i = 0; i < G->cacheCap; i++) {
+    if(G->cache[i].source == s) {
+      slot = &G->cache[i];
+      hit = true;
+      break;
+    }
+    // empty slots go first
+    if(slot->source != NIL && (G->cache[i].source == NIL || G->cache[i].used < slot->used)) {
+      slot = &G->cache[i];
+    }
+  }
+  int *t = G->color;
+  G->color = slot->color;
+  slot->color = t;
+  t = G->parent;
+  G->parent = slot->parent;
+  slot->parent = t;
+  t = G->distance;
+  G->distance = slot->distance;
+  slot->distance = t;
+  slot->source = G->fresh ? G->source : NIL;
+  slot->used = ++G->clock;
+  if(hit) G->source = s;
+  return hit;
 }
 
 void BFS(Graph G, int s) {
+  if(s > G->order || s < 1) {
+    fprintf(stderr, "%s error: s must meet 1 <= s <= getOrder(G)\n", __func__);
+    exit(1);
+  }
+  s = inner(G, s);
+  if(G->cacheCap > 0 && cacheSwap(G, s)) return;
+  G->fresh = true;
+  if(G->mode != BFS_QUEUE && !isCompressed(G)) freezeGraph(G);
+  if(isFrozen(G)) {
+    G->source = s;
+    memset(G->color, 0, sizeof(int) * (G->order + 1));
+    memset(G->distance, 0x80, sizeof(int) * (G->order + 1));
+    memset(G->parent, NIL, sizeof(int) * (G->order + 1));
+    if(isCompressed(G)) {
+      packedBFS(G, s);
+    } else if(G->mode == BFS_HYBRID) {
+      hybridBFS(G, s);
+    } else if(G->mode == BFS_PARALLEL) {
+      parallelBFS(G, s);
+    } else if(G->mode == BFS_BITMAP) {
+      bitmapBFS(G, s);
+    } else {
+      csrBFS(G, s);
+    }
+    return;
+  }
   G->source = s;
   for(int i = 1; i <= G->order; i++) {
     moveFront(G->adj[i]);
@@ -183,10 +1073,511 @@ void BFS(Graph G, int s) {
   freeList(&q);
 }
 
+// Expands the whole next level of one side of pairBFS: queue[*head..*tail)
+// is its frontier, own/other are the visit stamps of this side and the
+// other one. Returns the vertex where the sides meet (reached from *from),
+// or NIL.
+static int pairStep(Graph G, const int *off, const int *nbr, int *queue,
+                    int *head, int *tail, int own, int other, int *from) {
+  int end = *tail;
+  for(int i = *head; i < end; i++) {
+    int cur = queue[i];
+    for(int k = off[cur]; k < off[cur + 1]; k++) {
+      int x = nbr[k];
+      if(G->pairMark[x] == own) continue;
+      if(G->pairMark[x] == other) {
+        // the first meeting already closes a shortest path: every vertex
+        // the other side has seen is at most its current depth away
+        G->pairArcs += k - off[cur] + 1;
+        *from = cur;
+        return x;
+      }
+      G->pairMark[x] = own;
+      G->pairPar[x] = cur;
+      queue[(*tail)++] = x;
+    }
+    G->pairArcs += off[cur + 1] - off[cur];
+  }
+  *head = end;
+  return NIL;
+}
+
+int pairBFS(List L, Graph G, int u, int v) {
+  if(u > G->order || u < 1 || v > G->order || v < 1) {
+    fprintf(stderr, "%s error: u or v must meet 1 <= u <= getOrder(G)\n", __func__);
+    exit(1);
+  }
+  if(L == NULL) {
+    fprintf(stderr, "%s error: path list can not be null\n", __func__);
+    exit(1);
+  }
+  if(u == v) {
+    append(L, u);
+    return 0;
+  }
+  u = inner(G, u);
+  v = inner(G, v);
+  freezeGraph(G);
+  if(G->directed && G->roff == NULL) buildReverse(G);
+  const int *inOff = G->directed ? G->roff : G->off;
+  const int *inNbr = G->directed ? G->rnbr : G->nbr;
+  int n = G->order;
+  if(G->pairMark == NULL) {
+    G->pairMark = (int*)calloc(1, sizeof(int) * (n + 1));
+    G->pairPar = (int*)malloc(sizeof(int) * (n + 1));
+    G->pairQueue = (int*)malloc(sizeof(int) * 2 * (n + 1));
+  }
+  if(G->pairStamp > 0x7ffffff0) {
+    memset(G->pairMark, 0, sizeof(int) * (n + 1));
+    G->pairStamp = 0;
+  }
+  G->pairStamp += 2;
+  G->pairArcs = 0;
+  int fwd = G->pairStamp, bwd = fwd + 1;
+  int *fq = G->pairQueue, *bq = G->pairQueue + n + 1;
+  int fh = 0, ft = 0, bh = 0, bt = 0;
+  fq[ft++] = u;
+  bq[bt++] = v;
+  G->pairMark[u] = fwd;
+  G->pairMark[v] = bwd;
+  G->pairPar[u] = NIL;
+  G->pairPar[v] = NIL;
+  int fd = 0, bd = 0, meet = NIL, from = NIL;
+  bool forward = true;
+  while(meet == NIL && fh < ft && bh < bt) {
+    // grow the side with the smaller frontier
+    forward = (ft - fh) <= (bt - bh);
+    if(forward) {
+      meet = pairStep(G, G->off, G->nbr, fq, &fh, &ft, fwd, bwd, &from);
+      fd++;
+    } else {
+      meet = pairStep(G, inOff, inNbr, bq, &bh, &bt, bwd, fwd, &from);
+      bd++;
+    }
+  }
+  if(meet == NIL) {
+    append(L, NIL);
+    return INF;
+  }
+  // a -> b is the arc that joined the sides, a on u's side
+  int a = forward ? from : meet, b = forward ? meet : from;
+  append(L, outer(G, a));
+  for(int x = G->pairPar[a]; x != NIL; x = G->pairPar[x]) {
+    prepend(L, outer(G, x));
+  }
+  for(int x = b; x != NIL; x = G->pairPar[x]) {
+    append(L, outer(G, x));
+  }
+  return fd + bd;
+}
+
+// One multi-source BFS over up to 64 sources S[0..k), bit i standing for
+// S[i]. seen[v] holds the sources that reached v, visit[v] those that
+// reached it on the last level; a level ORs every visit word into the
+// neighbors' next words, so one adjacency scan advances all k searches.
+static void multiBatch(Graph G, const int *S, int k, int *D) {
+  int n = G->order;
+  uint64_t *seen = (uint64_t*)calloc(1, sizeof(uint64_t) * (n + 1));
+  uint64_t *visit = (uint64_t*)calloc(1, sizeof(uint64_t) * (n + 1));
+  uint64_t *next = (uint64_t*)calloc(1, sizeof(uint64_t) * (n + 1));
+  for(int i = 0; i < k; i++) {
+    memset(D + (size_t)i * (n + 1), 0x80, sizeof(int) * (n + 1));
+    seen[S[i]] |= (uint64_t)1 << i;
+    visit[S[i]] |= (uint64_t)1 << i;
+    D[(size_t)i * (n + 1) + S[i]] = 0;
+  }
+  bool active = true;
+  for(int level = 1; active; level++) {
+    active = false;
+    for(int v = 1; v <= n; v++) {
+      if(visit[v] == 0) continue;
+      for(int e = G->off[v]; e < G->off[v + 1]; e++) {
+        next[G->nbr[e]] |= visit[v];
+      }
+    }
+    for(int v = 1; v <= n; v++) {
+      uint64_t fresh = next[v] & ~seen[v];
+      next[v] = 0;
+      visit[v] = fresh;
+      if(fresh == 0) continue;
+      active = true;
+      seen[v] |= fresh;
+      while(fresh) {
+        int i = __builtin_ctzll(fresh);
+        D[(size_t)i * (n + 1) + v] = level;
+        fresh &= fresh - 1;
+      }
+    }
+  }
+  free(seen);
+  free(visit);
+  free(next);
+}
+
+void multiBFS(Graph G, const int *S, int k, int *D) {
+  for(int i = 0; i < k; i++) {
+    if(S[i] > G->order || S[i] < 1) {
+      fprintf(stderr, "%s error: sources must meet 1 <= s <= getOrder(G)\n", __func__);
+      exit(1);
+    }
+  }
+  freezeGraph(G);
+  int n = G->order;
+  int *in = (int*)malloc(sizeof(int) * 64);
+  int *row = (G->toNew != NULL) ? (int*)malloc(sizeof(int) * (n + 1)) : NULL;
+  for(int i = 0; i < k; i += 64) {
+    int m = (k - i < 64) ? k - i : 64;
+    for(int j = 0; j < m; j++) {
+      in[j] = inner(G, S[i + j]);
+    }
+    multiBatch(G, in, m, D + (size_t)i * (n + 1));
+    // rows come out indexed by internal id
+    for(int j = 0; row != NULL && j < m; j++) {
+      int *d = D + (size_t)(i + j) * (n + 1);
+      for(int v = 0; v <= n; v++) {
+        row[v] = d[G->toNew[v]];
+      }
+      memcpy(d, row, sizeof(int) * (n + 1));
+    }
+  }
+  free(in);
+  free(row);
+}
+
+void getDistPath(List L, Graph G, const int *dist, int u) {
+  if(u > G->order || u < 1) {
+    fprintf(stderr, "%s error: u must meet 1 <= u <= getOrder(G)\n", __func__);
+    exit(1);
+  }
+  if(dist[u] == INF) {
+    append(L, NIL);
+    return;
+  }
+  freezeGraph(G);
+  if(G->directed && G->roff == NULL) buildReverse(G);
+  const int *inOff = G->directed ? G->roff : G->off;
+  const int *inNbr = G->directed ? G->rnbr : G->nbr;
+  append(L, u);
+  int x = inner(G, u);
+  while(dist[outer(G, x)] > 0) {
+    int want = dist[outer(G, x)] - 1, k = inOff[x];
+    while(dist[outer(G, inNbr[k])] != want) {
+      k++;
+    }
+    x = inNbr[k];
+    prepend(L, outer(G, x));
+  }
+}
+
+// Vertices by decreasing degree, ties by id (counting sort).
+static void degreeOrder(Graph G, int *order) {
+  int n = G->order, maxDeg = 0;
+  for(int u = 1; u <= n; u++) {
+    int d = G->off[u + 1] - G->off[u];
+    if(d > maxDeg) maxDeg = d;
+  }
+  int *start = (int*)calloc(1, sizeof(int) * (maxDeg + 2));
+  for(int u = 1; u <= n; u++) {
+    start[maxDeg - (G->off[u + 1] - G->off[u]) + 1] += 1;
+  }
+  for(int d = 1; d <= maxDeg + 1; d++) {
+    start[d] += start[d - 1];
+  }
+  for(int u = 1; u <= n; u++) {
+    order[start[maxDeg - (G->off[u + 1] - G->off[u])]++] = u;
+  }
+  free(start);
+}
+
+static int compareLong(const void *a, const void *b) {
+  long long x = *(const long long*)a, y = *(const long long*)b;
+  return (x > y) - (x < y);
+}
+
+// Vertices in BFS visit order, one component after the other. With rcm
+// each component starts at its lowest-degree vertex, neighbors are taken in
+// increasing degree and the whole order is reversed (Cuthill-McKee).
+static void bfsOrder(Graph G, int *order, bool rcm) {
+  int n = G->order, tail = 0;
+  char *seen = (char*)calloc(1, n + 1);
+  int *start = (int*)malloc(sizeof(int) * (n > 0 ? n : 1));
+  long long *key = NULL;
+  int keyCap = 0;
+  if(rcm) {
+    degreeOrder(G, start);
+    for(int i = 0; i < n / 2; i++) {
+      int t = start[i];
+      start[i] = start[n - 1 - i];
+      start[n - 1 - i] = t;
+    }
+  } else {
+    for(int i = 0; i < n; i++) {
+      start[i] = i + 1;
+    }
+  }
+  for(int i = 0; i < n; i++) {
+    if(seen[start[i]]) continue;
+    int head = tail;
+    order[tail++] = start[i];
+    seen[start[i]] = 1;
+    while(head < tail) {
+      int cur = order[head++], deg = G->off[cur + 1] - G->off[cur], m = 0;
+      if(rcm && deg > keyCap) {
+        keyCap = deg * 2;
+        key = (long long*)realloc(key, sizeof(long long) * keyCap);
+      }
+      for(int k = G->off[cur]; k < G->off[cur + 1]; k++) {
+        int x = G->nbr[k];
+        if(seen[x]) continue;
+        seen[x] = 1;
+        if(rcm) {
+          key[m++] = (long long)(G->off[x + 1] - G->off[x]) * (n + 1) + x;
+        } else {
+          order[tail++] = x;
+        }
+      }
+      if(m > 0) {
+        qsort(key, m, sizeof(long long), compareLong);
+        for(int j = 0; j < m; j++) {
+          order[tail++] = (int)(key[j] % (n + 1));
+        }
+      }
+    }
+  }
+  if(rcm) {
+    for(int i = 0; i < n / 2; i++) {
+      int t = order[i];
+      order[i] = order[n - 1 - i];
+      order[n - 1 - i] = t;
+    }
+  }
+  free(key);
+  free(start);
+  free(seen);
+}
+
+void reorderGraph(Graph G, int method) {
+  if(method != ORDER_RCM && method != ORDER_BFS && method != ORDER_DEGREE) {
+    fprintf(stderr, "%s error: unknown vertex order %d\n", __func__, method);
+    exit(1);
+  }
+  bool packed = isCompressed(G);
+  freezeGraph(G);
+  int n = G->order;
+  int *order = (int*)malloc(sizeof(int) * (n > 0 ? n : 1));
+  if(method == ORDER_DEGREE) {
+    degreeOrder(G, order);
+  } else {
+    bfsOrder(G, order, method == ORDER_RCM);
+  }
+  // p maps the current internal ids to the new ones
+  int *p = (int*)calloc(1, sizeof(int) * (n + 1));
+  for(int i = 0; i < n; i++) {
+    p[order[i]] = i + 1;
+  }
+  int *off = (int*)calloc(1, sizeof(int) * (n + 2));
+  int *nbr = (int*)malloc(sizeof(int) * (G->off[n + 1] > 0 ? G->off[n + 1] : 1));
+  for(int x = 1; x <= n; x++) {
+    int y = order[x - 1], d = G->off[y + 1] - G->off[y];
+    off[x + 1] = off[x] + d;
+    for(int k = 0; k < d; k++) {
+      nbr[off[x] + k] = p[G->nbr[G->off[y] + k]];
+    }
+    sortRow(nbr + off[x], d);
+  }
+  freeCSR(G);
+  G->off = off;
+  G->nbr = nbr;
+  // compose with the earlier relabeling and carry the BFS state over
+  int *toOld = (int*)calloc(1, sizeof(int) * (n + 1));
+  if(G->toNew == NULL) {
+    G->toNew = (int*)calloc(1, sizeof(int) * (n + 1));
+    for(int u = 1; u <= n; u++) {
+      G->toNew[u] = u;
+    }
+  }
+  for(int u = 1; u <= n; u++) {
+    G->toNew[u] = p[G->toNew[u]];
+    toOld[G->toNew[u]] = u;
+  }
+  free(G->toOld);
+  G->toOld = toOld;
+  int *t = (int*)malloc(sizeof(int) * (n + 1));
+  int *arrays[3] = {G->color, G->parent, G->distance};
+  for(int a = 0; a < 3; a++) {
+    t[0] = arrays[a][0];
+    for(int y = 1; y <= n; y++) {
+      t[p[y]] = (a == 1) ? p[arrays[a][y]] : arrays[a][y];
+    }
+    memcpy(arrays[a], t, sizeof(int) * (n + 1));
+  }
+  G->source = p[G->source];
+  for(int i = 0; i < G->cacheCap; i++) {
+    G->cache[i].source = NIL;
+  }
+  free(t);
+  free(p);
+  free(order);
+  if(packed) compressGraph(G);
+}
+
+// Binary graph file: this header, then the order + 2 offsets and the arcs
+// neighbors, then for a relabeled graph the order + 1 caller ids of the
+// internal ones, all 32-bit ints in host byte order.
+typedef struct GraphFileHeader {
+  char magic[8];    // GRAPH_MAGIC
+  int order;
+  int flags;        // GRAPH_DIRECTED | GRAPH_RELABELED
+  long long size;
+  long long arcs;
+}GraphFileHeader;
+
+#define GRAPH_MAGIC "CSRGRPH1"
+#define GRAPH_DIRECTED 1
+#define GRAPH_RELABELED 2
+
+void saveGraph(Graph G, const char *path) {
+  bool packed = isCompressed(G);
+  freezeGraph(G);
+  FILE *out = fopen(path, "wb");
+  if(out == NULL) {
+    fprintf(stderr, "%s error: failed to write file %s\n", __func__, path);
+    exit(1);
+  }
+  GraphFileHeader h;
+  memset(&h, 0, sizeof(h));
+  memcpy(h.magic, GRAPH_MAGIC, sizeof(h.magic));
+  h.order = G->order;
+  h.flags = (G->directed ? GRAPH_DIRECTED : 0) | (G->toOld != NULL ? GRAPH_RELABELED : 0);
+  h.size = G->size;
+  h.arcs = G->off[G->order + 1];
+  if(fwrite(&h, sizeof(h), 1, out) != 1 ||
+     fwrite(G->off, sizeof(int), G->order + 2, out) != (size_t)G->order + 2 ||
+     fwrite(G->nbr, sizeof(int), h.arcs, out) != (size_t)h.arcs ||
+     (G->toOld != NULL &&
+      fwrite(G->toOld, sizeof(int), G->order + 1, out) != (size_t)G->order + 1) ||
+     fclose(out) != 0) {
+    fprintf(stderr, "%s error: failed to write file %s\n", __func__, path);
+    exit(1);
+  }
+  if(packed) compressGraph(G);
+}
+
+Graph loadGraph(const char *path) {
+  int fd = open(path, O_RDONLY);
+  if(fd < 0) {
+    fprintf(stderr, "%s error: failed to open file %s\n", __func__, path);
+    exit(1);
+  }
+  struct stat st;
+  GraphFileHeader h;
+  if(fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(h) ||
+     read(fd, &h, sizeof(h)) != (ssize_t)sizeof(h) ||
+     memcmp(h.magic, GRAPH_MAGIC, sizeof(h.magic)) != 0 || h.order < 0 ||
+     h.arcs < 0 || h.arcs > 0x7fffffff ||
+     (size_t)st.st_size != sizeof(h) + sizeof(int) * ((size_t)h.order + 2 + h.arcs +
+                           ((h.flags & GRAPH_RELABELED) ? (size_t)h.order + 1 : 0))) {
+    fprintf(stderr, "%s error: %s is not a graph file\n", __func__, path);
+    exit(1);
+  }
+  void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if(map == MAP_FAILED) {
+    fprintf(stderr, "%s error: failed to map file %s\n", __func__, path);
+    exit(1);
+  }
+  Graph G = allocGraph(h.order);
+  G->map = map;
+  G->mapLen = st.st_size;
+  G->off = (int*)((char*)map + sizeof(h));
+  G->nbr = G->off + h.order + 2;
+  G->size = h.size;
+  G->directed = (h.flags & GRAPH_DIRECTED) != 0;
+  // one O(n + m) pass, so no search can index outside the mapping
+  bool broken = G->off[1] != 0 || G->off[h.order + 1] != h.arcs;
+  for(int u = 1; u <= h.order && !broken; u++) {
+    broken = G->off[u] > G->off[u + 1];
+  }
+  for(int k = 0; k < h.arcs && !broken; k++) {
+    broken = G->nbr[k] < 1 || G->nbr[k] > h.order;
+  }
+  if(broken) {
+    fprintf(stderr, "%s error: %s has broken offsets or neighbors\n", __func__, path);
+    exit(1);
+  }
+  if(h.flags & GRAPH_RELABELED) {
+    const int *ids = G->nbr + h.arcs;
+    G->toOld = (int*)malloc(sizeof(int) * (h.order + 1));
+    G->toNew = (int*)calloc(1, sizeof(int) * (h.order + 1));
+    memcpy(G->toOld, ids, sizeof(int) * (h.order + 1));
+    // toOld has to be a permutation of 1 .. order that keeps NIL
+    broken = G->toOld[0] != NIL;
+    for(int x = 1; x <= h.order && !broken; x++) {
+      int u = G->toOld[x];
+      broken = u < 1 || u > h.order || G->toNew[u] != 0;
+      if(!broken) G->toNew[u] = x;
+    }
+    if(broken) {
+      fprintf(stderr, "%s error: %s has broken vertex ids\n", __func__, path);
+      exit(1);
+    }
+  }
+  return G;
+}
+
 /*** Other operations ***/
+// printGraph for a relabeled or compressed graph: every row is decoded, goes
+// back to caller ids and is sorted again.
+static void printRelabeled(FILE* out, Graph G) {
+  int *row = NULL, cap = 0;
+  for(int i = 1; i <= G->order; i++) {
+    int x = inner(G, i), d = 0;
+    int deg = isCompressed(G) ? packDegree(G, x) :
+              isFrozen(G) ? G->off[x + 1] - G->off[x] : length(G->adj[x]);
+    if(deg > cap) {
+      cap = deg * 2;
+      row = (int*)realloc(row, sizeof(int) * cap);
+    }
+    if(isCompressed(G)) {
+      d = unpackRow(G, x, row);
+      for(int k = 0; k < d; k++) {
+        row[k] = outer(G, row[k]);
+      }
+    } else if(isFrozen(G)) {
+      for(int k = G->off[x]; k < G->off[x + 1]; k++) {
+        row[d++] = outer(G, G->nbr[k]);
+      }
+    } else {
+      for(moveFront(G->adj[x]); index(G->adj[x]) >= 0; moveNext(G->adj[x])) {
+        row[d++] = outer(G, get(G->adj[x]));
+      }
+    }
+    sortRow(row, d);
+    fprintf(out, "%d:", i);
+    if(d == 0) fprintf(out, " ");
+    for(int k = 0; k < d; k++) {
+      fprintf(out, " %d", row[k]);
+    }
+    fprintf(out, "\n");
+  }
+  free(row);
+}
+
 void printGraph(FILE* out, Graph G) {
+  if(G->toNew != NULL || isCompressed(G)) {
+    printRelabeled(out, G);
+    return;
+  }
   for(int i = 1; i <= G->order; i++) {
     fprintf(out, "%d:", i);
+    if(isFrozen(G)) {
+      if(G->off[i] == G->off[i + 1]) fprintf(out, " ");
+      for(int k = G->off[i]; k < G->off[i + 1]; k++) {
+        fprintf(out, " %d", G->nbr[k]);
+      }
+      fprintf(out, "\n");
+      continue;
+    }
     List list = G->adj[i];
     moveFront(list);
     if(index(list) < 0) {
@@ -10,11 +10,58 @@ enum Color {
   BLACK
 };
 
+// How BFS explores the graph, see setBFSMode()
+enum BFSMode {
+  BFS_QUEUE,  // one vertex at a time from a FIFO queue
+  BFS_HYBRID, // direction-optimizing: top-down or bottom-up per level
+  BFS_PARALLEL, // level-synchronous, large levels split across threads
+  BFS_BITMAP  // visited bitmap, frontier as an array or a bitmap per level
+};
+
+// Vertex orders for reorderGraph()
+enum VertexOrder {
+  ORDER_RCM,    // reverse Cuthill-McKee: BFS from low-degree vertices
+  ORDER_BFS,    // plain BFS visit order
+  ORDER_DEGREE  // highest degree first
+};
+
+// One remembered BFS run, see setBFSCache()
+typedef struct BFSResult {
+  int source;     // NIL when the slot is empty
+  long long used; // last use, for LRU eviction
+  int *color;
+  int *parent;
+  int *distance;
+}BFSResult;
+
 typedef struct GraphObj {
   int order;  // n node
   int size;   // n edge
   int source; // start node
-  List *adj;
+  List *adj;  // adjacency lists, NULL while the graph is frozen
+  int *off;   // frozen (CSR) form: the neighbors of u are nbr[off[u]] ..
+  int *nbr;   // nbr[off[u + 1] - 1] in increasing order, NULL until frozen
+  int *roff;  // frozen in-neighbors of a directed graph, built by the first
+  int *rnbr;  // bottom-up BFS step
+  bool directed; // set once addArc is used
+  int mode;   // enum BFSMode
+  int threads; // workers for BFS_PARALLEL, 1 by default
+  bool fresh; // color/parent/distance still match the edges
+  bool incremental; // addEdge/addArc repair a fresh BFS tree in place
+  BFSResult *cache; // the last cacheCap results besides the current one
+  int cacheCap;
+  long long clock;
+  int *pairMark;  // pairBFS scratch, allocated on first use: visit stamps,
+  int *pairPar;   // parents toward the side's root, and the two queues
+  int *pairQueue;
+  int pairStamp;
+  long long pairArcs; // arcs scanned by the last pairBFS, for GraphBench
+  void *map;      // file mapping behind off/nbr after loadGraph(), or NULL
+  size_t mapLen;
+  int *toNew;     // after reorderGraph(): internal id of every caller id and
+  int *toOld;     // back, NULL while the ids are the caller's own
+  unsigned char *pack; // compressed form: the row of u is pack[packOff[u]] ..
+  size_t *packOff;     // pack[packOff[u + 1] - 1], off/nbr are NULL then
   int *color;
   int *parent;
   int *distance;
@@ -36,5 +83,51 @@ void makeNull(Graph G);
 void addEdge(Graph G, int u, int v);
 void addArc(Graph G, int u, int v);
 void BFS(Graph G, int s);
+void freezeGraph(Graph G); // Packs the adjacency lists into CSR arrays and
+ // frees the lists. BFS then scans contiguous memory. Adding an edge to a
+ // frozen graph unpacks it again.
+bool isFrozen(Graph G);
+void compressGraph(Graph G); // Freezes G and stores every sorted row as
+ // varint gaps (the first one from u itself), about 1-2 bytes per arc. BFS
+ // decodes rows on the fly with the queue engine whatever the mode; the
+ // other engines, pairBFS, multiBFS and adding edges unpack it first.
+bool isCompressed(Graph G);
+void saveGraph(Graph G, const char *path); // Writes G (frozen first) as a
+ // binary file: header, CSR offsets, neighbors, 32-bit ints.
+Graph loadGraph(const char *path); // Maps a saveGraph() file read-only and
+ // returns a frozen Graph over it, without copying the arrays. One O(n + m)
+ // pass checks the offsets, neighbors and vertex ids first; a broken file is
+ // an error. Adding edges copies them out first.
+void reorderGraph(Graph G, int order); // Relabels the vertices internally
+ // in the given enum VertexOrder so BFS touches nearby memory. Every
+ // function keeps taking and returning the caller's ids. Freezes the graph.
+void loadEdges(Graph G, const int *U, const int *V, int m, bool directed);
+ // Adds the m edges (arcs if directed) U[i]-V[i] in one go: buckets them by
+ // vertex, sorts every row once and drops repeats, in O(E log d) instead
+ // of a sorted List insertion per edge. Leaves the graph frozen.
+void setBFSIncremental(Graph G, bool on); // With on, addEdge/addArc keep
+ // the current BFS tree: only vertices the new edge brings closer to the
+ // source get a new distance and parent. A repair that would touch more than
+ // an eighth of the vertices runs a full BFS instead. Off by default.
+void setBFSCache(Graph G, int k); // Keeps the last k BFS results besides the
+ // current one. BFS from a cached source swaps its arrays back in O(1)
+ // instead of searching again. Adding edges empties the cache. k = 0 (the
+ // default) turns it off.
+void setBFSMode(Graph G, int mode); // Picks the BFS engine. BFS_HYBRID freezes
+ // the graph on the next BFS and switches to bottom-up steps on large
+ // frontiers. Distances are the same in every mode, parents may be any
+ // neighbor one level up.
+void setBFSThreads(Graph G, int threads); // Worker threads for BFS_PARALLEL.
+int pairBFS(List L, Graph G, int u, int v); // Bidirectional BFS from u and v
+ // that stops where the two searches meet. Appends a shortest u-v path to L
+ // (NIL if there is none, like getPath) and returns its length or INF.
+ // Freezes the graph; the BFS state read by getDist/getPath is untouched.
+void multiBFS(Graph G, const int *S, int k, int *D); // Distances from the k
+ // sources S[0..k) at once, 64 per pass over the graph (bit-parallel MS-BFS).
+ // D must hold k * (getOrder(G) + 1) ints; D[i * (getOrder(G) + 1) + v]
+ // becomes the distance from S[i] to v, or INF. Freezes the graph.
+void getDistPath(List L, Graph G, const int *dist, int u); // Appends to L a
+ // shortest path to u read from one row of multiBFS output (NIL if u is
+ // unreachable), stepping to the smallest in-neighbor one level closer.
 /*** Other operations ***/
 void printGraph(FILE* out, Graph G);
\ No newline at end of file
@@ -0,0 +1,237 @@
+//-----------------------------------------------------------------------------
+// GraphBench.c
+// BFS benchmark over generated graphs, see make bench. For every graph
+// family and every representation/engine prints the load time, the time per
+// search, millions of traversed edges per second (edges in the searched
+// component / time, multi counted the same way; pair-scan counts half the
+// arcs pairBFS really scanned, since it stops long before the component is
+// done), the bytes held by the representation and the process' peak RSS so
+// far.
+//-----------------------------------------------------------------------------
+#include "Graph.h"
+#include "GraphGen.h"
+#include "List.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+// the list engine is quadratic, only small graphs get it
+#define LIST_MAX 4096
+
+static volatile long long sink;
+
+static double now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static double peakMB(void) {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss / 1024.0;
+}
+
+// Bytes behind the current adjacency of G.
+static double graphMB(Graph G) {
+  int n = getOrder(G);
+  double bytes;
+  if(isCompressed(G)) {
+    bytes = sizeof(size_t) * (n + 2.0) + G->packOff[n + 1];
+  } else if(isFrozen(G)) {
+    bytes = sizeof(int) * (n + 2.0 + G->off[n + 1]);
+    if(G->roff != NULL) bytes += sizeof(int) * (n + 2.0 + G->off[n + 1]);
+  } else {
+    bytes = sizeof(ListObj) * (n + 1.0);
+    for(int u = 1; u <= n; u++) {
+      bytes += sizeof(ListNode) * (double)length(G->adj[u]);
+    }
+  }
+  if(G->toNew != NULL) bytes += sizeof(int) * 2.0 * (n + 1);
+  return bytes / (1 << 20);
+}
+
+static void header(void) {
+  printf("%-9s %-11s %9s %10s %9s %9s %9s %9s %9s\n", "graph", "engine", "n", "edges",
+         "load ms", "ms/run", "MTEPS", "graphMB", "peakMB");
+}
+
+static void report(const char *graph, const char *engine, Graph G, int m, double load,
+                   double ms, int runs, double edges) {
+  printf("%-9s %-11s %9d %10d %9.1f %9.2f %9.1f %9.1f %9.1f\n", graph, engine, getOrder(G),
+         m, load, ms / runs, edges / ms / 1e3, graphMB(G), peakMB());
+}
+
+// Edges in the component of the last BFS source: half the degrees of the
+// vertices it reached.
+static double reached(Graph G, const int *deg) {
+  long long arcs = 0;
+  for(int v = 1; v <= getOrder(G); v++) {
+    if(getDist(G, v) >= 0) arcs += deg[v];
+  }
+  return arcs / 2.0;
+}
+
+// k BFS runs from S in the current mode.
+static void runBFS(const char *graph, const char *engine, Graph G, int m, double load,
+                   const int *S, int k, const int *deg) {
+  double ms = 0, edges = 0;
+  for(int i = 0; i < k; i++) {
+    double t0 = now();
+    BFS(G, S[i]);
+    ms += now() - t0;
+    edges += reached(G, deg);
+  }
+  report(graph, engine, G, m, load, ms, k, edges);
+}
+
+static void runPair(const char *graph, Graph G, int m, const int *S, int k, const int *T) {
+  List L = newList();
+  double ms = 0, edges = 0;
+  for(int i = 0; i < k; i++) {
+    clear(L);
+    double t0 = now();
+    sink = pairBFS(L, G, S[i], T[i]);
+    ms += now() - t0;
+    edges += G->pairArcs / 2.0;
+  }
+  freeList(&L);
+  report(graph, "pair-scan", G, m, 0, ms, k, edges);
+}
+
+static void runMulti(const char *graph, Graph G, int m, const int *S, int k,
+                     const double *comp) {
+  int *D = (int*)malloc(sizeof(int) * (size_t)k * (getOrder(G) + 1));
+  double edges = 0;
+  for(int i = 0; i < k; i++) {
+    edges += comp[i];
+  }
+  double t0 = now();
+  multiBFS(G, S, k, D);
+  double ms = now() - t0;
+  sink = D[1];
+  free(D);
+  report(graph, "multi", G, m, 0, ms, k, edges);
+}
+
+static void bench(int kind, int scale, int degree, int k, int threads, unsigned long long seed) {
+  const char *name = kindName(kind);
+  double t0 = now();
+  EdgeList E = genGraph(kind, scale, degree, seed);
+  double gen = now() - t0;
+  int n = E->order;
+  printf("# %s: %d vertices, %d arcs, generated in %.1f ms\n", name, n, E->size, gen);
+
+  t0 = now();
+  Graph G = newGraph(n);
+  loadEdges(G, E->U, E->V, E->size, false);
+  double load = now() - t0;
+  int m = getSize(G);
+  int *deg = (int*)calloc(1, sizeof(int) * (n + 1));
+  for(int u = 1; u <= n; u++) {
+    deg[u] = G->off[u + 1] - G->off[u];
+  }
+  // sources with at least one edge, same ones for every engine
+  int *S = (int*)malloc(sizeof(int) * k);
+  int *T = (int*)malloc(sizeof(int) * k);
+  double *comp = (double*)malloc(sizeof(double) * k);
+  srand((unsigned)seed);
+  for(int i = 0; i < k; i++) {
+    do {
+      S[i] = 1 + rand() % n;
+    } while(deg[S[i]] == 0);
+    T[i] = 1 + rand() % n;
+  }
+  for(int i = 0; i < k; i++) {
+    BFS(G, S[i]);
+    comp[i] = reached(G, deg);
+  }
+
+  if(n <= LIST_MAX) {
+    t0 = now();
+    // one addEdge per edge of G, the arc lists may hold both directions
+    Graph L = newGraph(n);
+    for(int u = 1; u <= n; u++) {
+      for(int j = G->off[u]; j < G->off[u + 1]; j++) {
+        if(u < G->nbr[j]) addEdge(L, u, G->nbr[j]);
+      }
+    }
+    runBFS(name, "list", L, getSize(L), now() - t0, S, k, deg);
+    freeGraph(&L);
+  }
+  runBFS(name, "queue", G, m, load, S, k, deg);
+  setBFSMode(G, BFS_HYBRID);
+  runBFS(name, "hybrid", G, m, 0, S, k, deg);
+  setBFSMode(G, BFS_PARALLEL);
+  setBFSThreads(G, threads);
+  runBFS(name, "parallel", G, m, 0, S, k, deg);
+  setBFSMode(G, BFS_BITMAP);
+  runBFS(name, "bitmap", G, m, 0, S, k, deg);
+  setBFSMode(G, BFS_QUEUE);
+  runPair(name, G, m, S, k, T);
+  runMulti(name, G, m, S, k, comp);
+
+  char path[] = "GraphBench.bin";
+  saveGraph(G, path);
+  t0 = now();
+  Graph M = loadGraph(path);
+  double mapped = now() - t0;
+  runBFS(name, "mmap", M, m, mapped, S, k, deg);
+  freeGraph(&M);
+  unlink(path);
+
+  t0 = now();
+  compressGraph(G);
+  runBFS(name, "packed", G, m, now() - t0, S, k, deg);
+  t0 = now();
+  freezeGraph(G);
+  reorderGraph(G, ORDER_RCM);
+  runBFS(name, "rcm", G, m, now() - t0, S, k, deg);
+  t0 = now();
+  compressGraph(G);
+  runBFS(name, "rcm+packed", G, m, now() - t0, S, k, deg);
+
+  freeGraph(&G);
+  free(deg);
+  free(S);
+  free(T);
+  free(comp);
+  freeEdgeList(&E);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: GraphBench [-g rmat|er|grid|powerlaw] [-s scale] [-d degree] [-k sources] [-t threads] [-r seed]\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  int kind = -1, scale = 18, degree = 16, k = 8;
+  int threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+  unsigned long long seed = 1;
+  for(int i = 1; i < argc; i += 2) {
+    if(i + 1 >= argc) usage();
+    if(strcmp(argv[i], "-g") == 0) {
+      if((kind = kindByName(argv[i + 1])) < 0) usage();
+    } else if(strcmp(argv[i], "-s") == 0) {
+      scale = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-d") == 0) {
+      degree = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-k") == 0) {
+      k = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-t") == 0) {
+      threads = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-r") == 0) {
+      seed = strtoull(argv[i + 1], NULL, 10);
+    } else {
+      usage();
+    }
+  }
+  if(k < 1 || threads < 1) usage();
+  header();
+  for(int g = GEN_RMAT; g <= GEN_POWERLAW; g++) {
+    if(kind < 0 || kind == g) bench(g, scale, degree, k, threads, seed);
+  }
+}
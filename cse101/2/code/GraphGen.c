@@ -0,0 +1,169 @@
+// cse101/2/code and cse101/3/code each hold a copy of this file (and of
+// GraphGen.h); they must stay byte-identical, so change both together.
+#include "GraphGen.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *names[] = {"rmat", "er", "grid", "powerlaw"};
+
+// xorshift64*, so graphs do not depend on the C library's rand()
+static uint64_t nextRand(uint64_t *s) {
+  *s ^= *s >> 12;
+  *s ^= *s << 25;
+  *s ^= *s >> 27;
+  return *s * 0x2545F4914F6CDD1Dull;
+}
+
+// Uniform in [0, n)
+static int randBelow(uint64_t *s, int n) {
+  return (int)((nextRand(s) >> 32) * (uint64_t)n >> 32);
+}
+
+static int compareArc(const void *a, const void *b) {
+  uint64_t x = *(const uint64_t*)a, y = *(const uint64_t*)b;
+  return (x > y) - (x < y);
+}
+
+// Sorts the arcs (packed as u << 32 | v), drops self loops and repeats and
+// unpacks them into E.
+static void finish(EdgeList E, uint64_t *arc, long long m) {
+  qsort(arc, m, sizeof(uint64_t), compareArc);
+  E->U = (int*)malloc(sizeof(int) * (m > 0 ? m : 1));
+  E->V = (int*)malloc(sizeof(int) * (m > 0 ? m : 1));
+  int k = 0;
+  for(long long i = 0; i < m; i++) {
+    int u = (int)(arc[i] >> 32), v = (int)(arc[i] & 0xffffffffu);
+    if(u == v || (i > 0 && arc[i] == arc[i - 1])) continue;
+    E->U[k] = u;
+    E->V[k] = v;
+    k++;
+  }
+  E->size = k;
+}
+
+static long long rmat(uint64_t *arc, int scale, long long m, uint64_t *s) {
+  int n = 1 << scale;
+  int *perm = (int*)malloc(sizeof(int) * n);
+  for(int i = 0; i < n; i++) {
+    perm[i] = i;
+  }
+  for(int i = n - 1; i > 0; i--) {
+    int j = randBelow(s, i + 1), t = perm[i];
+    perm[i] = perm[j];
+    perm[j] = t;
+  }
+  for(long long i = 0; i < m; i++) {
+    int u = 0, v = 0;
+    for(int b = 0; b < scale; b++) {
+      int r = randBelow(s, 100);
+      if(r >= 57 && r < 76) {
+        v |= 1 << b;
+      } else if(r >= 76 && r < 95) {
+        u |= 1 << b;
+      } else if(r >= 95) {
+        u |= 1 << b;
+        v |= 1 << b;
+      }
+    }
+    arc[i] = (uint64_t)(perm[u] + 1) << 32 | (uint64_t)(perm[v] + 1);
+  }
+  free(perm);
+  return m;
+}
+
+static long long er(uint64_t *arc, int n, long long m, uint64_t *s) {
+  for(long long i = 0; i < m; i++) {
+    arc[i] = (uint64_t)(randBelow(s, n) + 1) << 32 | (uint64_t)(randBelow(s, n) + 1);
+  }
+  return m;
+}
+
+static long long grid(uint64_t *arc, int scale) {
+  int cols = 1 << ((scale + 1) / 2), rows = 1 << (scale / 2);
+  long long m = 0;
+  for(int r = 0; r < rows; r++) {
+    for(int c = 0; c < cols; c++) {
+      uint64_t u = (uint64_t)r * cols + c + 1;
+      if(c + 1 < cols) {
+        arc[m++] = u << 32 | (u + 1);
+        arc[m++] = (u + 1) << 32 | u;
+      }
+      if(r + 1 < rows) {
+        arc[m++] = u << 32 | (u + cols);
+        arc[m++] = (u + cols) << 32 | u;
+      }
+    }
+  }
+  return m;
+}
+
+// Every new vertex links to degree existing endpoints, picked from the arc
+// list so far (so in proportion to their degree).
+static long long powerlaw(uint64_t *arc, int n, int degree, uint64_t *s) {
+  int *ends = (int*)malloc(sizeof(int) * 2 * ((long long)n * degree + 1));
+  long long m = 0, ne = 0;
+  ends[ne++] = 1;
+  for(int u = 2; u <= n; u++) {
+    for(int j = 0; j < degree; j++) {
+      int v = ends[(long long)(nextRand(s) % (uint64_t)ne)];
+      if(nextRand(s) & 1) {
+        arc[m++] = (uint64_t)u << 32 | (uint64_t)v;
+      } else {
+        arc[m++] = (uint64_t)v << 32 | (uint64_t)u;
+      }
+      ends[ne++] = u;
+      ends[ne++] = v;
+    }
+  }
+  free(ends);
+  return m;
+}
+
+EdgeList genGraph(int kind, int scale, int degree, unsigned long long seed) {
+  if(scale < 1 || scale > 30 || degree < 1 || (long long)degree << scale > 0x7fffffff) {
+    fprintf(stderr, "%s error: need 1 <= scale <= 30 and degree * 2^scale < 2^31\n", __func__);
+    exit(1);
+  }
+  int n = 1 << scale;
+  uint64_t s = seed * 0x9E3779B97F4A7C15ull + 1;
+  long long cap = (kind == GEN_GRID) ? 4LL * n : (long long)degree * n;
+  uint64_t *arc = (uint64_t*)malloc(sizeof(uint64_t) * cap);
+  long long m = 0;
+  if(kind == GEN_RMAT) {
+    m = rmat(arc, scale, cap, &s);
+  } else if(kind == GEN_ER) {
+    m = er(arc, n, cap, &s);
+  } else if(kind == GEN_GRID) {
+    m = grid(arc, scale);
+  } else if(kind == GEN_POWERLAW) {
+    m = powerlaw(arc, n, degree, &s);
+  } else {
+    fprintf(stderr, "%s error: unknown graph kind %d\n", __func__, kind);
+    exit(1);
+  }
+  EdgeList E = (EdgeList)calloc(1, sizeof(EdgeListObj));
+  E->order = n;
+  finish(E, arc, m);
+  free(arc);
+  return E;
+}
+
+void freeEdgeList(EdgeList* pE) {
+  free((*pE)->U);
+  free((*pE)->V);
+  free(*pE);
+  *pE = NULL;
+}
+
+const char *kindName(int kind) {
+  return (kind >= 0 && kind <= GEN_POWERLAW) ? names[kind] : "?";
+}
+
+int kindByName(const char *name) {
+  for(int k = 0; k <= GEN_POWERLAW; k++) {
+    if(strcmp(name, names[k]) == 0) return k;
+  }
+  return -1;
+}
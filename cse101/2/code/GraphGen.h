@@ -0,0 +1,31 @@
+#pragma once
+// cse101/2/code and cse101/3/code each hold a copy of this file (and of
+// GraphGen.c); they must stay byte-identical, so change both together.
+#include <stdbool.h>
+
+// Synthetic graph families for GraphBench
+enum GraphKind {
+  GEN_RMAT,     // recursive matrix (0.57, 0.19, 0.19, 0.05), ids shuffled
+  GEN_ER,       // Erdos-Renyi: arcs between uniformly random vertices
+  GEN_GRID,     // 2D grid, arcs both ways between side neighbors
+  GEN_POWERLAW  // preferential attachment, every arc in a random direction
+};
+
+// A generated graph as an arc list: no self loops, no repeated arcs,
+// sorted by (U[i], V[i]).
+typedef struct EdgeListObj {
+  int order;  // vertices are 1 .. order
+  int size;   // number of arcs
+  int *U;
+  int *V;
+}EdgeListObj;
+
+typedef EdgeListObj* EdgeList;
+
+EdgeList genGraph(int kind, int scale, int degree, unsigned long long seed);
+ // 2^scale vertices and about degree * 2^scale arcs (before repeats are
+ // dropped; grids always have 4 per inner vertex). The same arguments give
+ // the same graph on every machine.
+void freeEdgeList(EdgeList* pE);
+const char *kindName(int kind);
+int kindByName(const char *name); // -1 for an unknown name
@@ -23,6 +23,43 @@ int main() {
   BFS(g, 1);
   getPath(path, g, 4);
   printList(stdout, path);
+
+  freezeGraph(g);
+  printGraph(stdout, g);
+  clear(path);
+  BFS(g, 4);
+  getPath(path, g, 1);
+  printList(stdout, path);
+  addEdge(g, 3, 4);
+  printf("%d %d\n", isFrozen(g), getSize(g));
+  printGraph(stdout, g);
+  setBFSCache(g, 2);
+  BFS(g, 1);
+  BFS(g, 3);
+  BFS(g, 1);
+  clear(path);
+  getPath(path, g, 3);
+  printList(stdout, path);
+  reorderGraph(g, ORDER_RCM);
+  printGraph(stdout, g);
+  BFS(g, 4);
+  clear(path);
+  getPath(path, g, 1);
+  printList(stdout, path);
+  printf("%d %d\n", getSource(g), getParent(g, 1));
+  compressGraph(g);
+  printGraph(stdout, g);
+  BFS(g, 3);
+  clear(path);
+  getPath(path, g, 1);
+  printList(stdout, path);
+  printf("%d %d\n", isCompressed(g), getDist(g, 1));
+  setBFSIncremental(g, true);
+  BFS(g, 1);
+  addEdge(g, 1, 3);
+  printf("%d %d %d\n", getSource(g), getDist(g, 3), getParent(g, 3));
+  makeNull(g);
+  printGraph(stdout, g);
   freeList(&path);
   freeGraph(&g);
 
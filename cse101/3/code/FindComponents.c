@@ -8,8 +8,21 @@
 extern char *strtok_r(char *restrict __s, const char *restrict __delim, char **restrict __save_ptr);
 
 int main(int argc, char **argv) {
+  // -e pearce: one DFS over G through SCC(); the default kosaraju output
+  // keeps the member order of the two DFS passes
+  bool pearce = false;
+  if(argc == 5 && strcmp(argv[1], "-e") == 0) {
+    if(strcmp(argv[2], "pearce") == 0) {
+      pearce = true;
+    } else if(strcmp(argv[2], "kosaraju") != 0) {
+      fprintf(stderr, "unknown SCC engine %s\n", argv[2]);
+      exit(EXIT_FAILURE);
+    }
+    argv += 2;
+    argc -= 2;
+  }
   if(argc != 3) {
-    fprintf(stderr, "usage: %s infile outfile\n", argv[0]);
+    fprintf(stderr, "usage: %s [-e pearce|kosaraju] infile outfile\n", argv[0]);
     exit(EXIT_FAILURE);
   }
   FILE *in = fopen(argv[1], "r");
@@ -33,6 +46,15 @@ int main(int argc, char **argv) {
   }
   fprintf(out, "Adjacency list representation of G:\n");
   printGraph(out, g);
+  if(pearce) {
+    SCC(g);
+    fprintf(out, "\n");
+    printGraphSCC(out, g);
+    freeGraph(&g);
+    fclose(in);
+    fclose(out);
+    return 0;
+  }
 
   List l = newList();
   for(int i = 1;i <= n;  i++) {
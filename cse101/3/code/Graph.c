@@ -44,6 +44,7 @@ void freeGraph(Graph* pG) {
   free((*pG)->discover);
   free((*pG)->finish);
   free((*pG)->distance);
+  free((*pG)->component);
   free((*pG)->adj);
   free(*pG);
   (*pG) = NULL;
@@ -116,6 +117,8 @@ void makeNull(Graph G) {
   G->order = 0;
   G->source = 0;
   G->size = 0;
+  free(G->component);
+  G->component = NULL;
   memset(G->color, 0, sizeof(int) * (G->order + 1));
   memset(G->distance, 0x80, sizeof(int) * (G->order + 1));
   memset(G->parent, 0, sizeof(int) * (G->order + 1));
@@ -141,6 +144,8 @@ void addEdge(Graph G, int u, int v) {
   addHelp(G, u, v);
   addHelp(G, v, u);
   G->size += 1;
+  free(G->component);
+  G->component = NULL;
 }
 
 void addArc(Graph G, int u, int v) {
@@ -156,6 +161,8 @@ void addArc(Graph G, int u, int v) {
   }
   addHelp(G, u, v);
   G->size += 1;
+  free(G->component);
+  G->component = NULL;
 }
 
 void BFS(Graph G, int s) {
@@ -228,22 +235,36 @@ int getFinish(Graph G, int u) {
   return G->finish[u];
 }
 
-void visit(Graph g, int u, int *time_stamp) {
-  // printf("visit: %d\n", u);
+// The DFS tree under u without recursion: stack holds the open vertices and
+// cur[v] the next adjacency node v will look at, so every vertex resumes
+// where its recursive call would have. Times and parents are those of the
+// recursive visit. Finished vertices are prepended to done (if not NULL).
+static void visit(Graph g, int u, int *time_stamp, int *stack, ListNode **cur, List done) {
+  int top = 0;
   g->discover[u] = ++(*time_stamp);
   g->color[u] = GRAY;
-  List l = g->adj[u];
-  moveFront(l);
-  while(index(l) >= 0 ) {
-    int v = get(l);
-    if(g->color[v] == WHITE) {
-      g->parent[v] = u;
-      visit(g, v, time_stamp);
+  cur[u] = g->adj[u]->head;
+  stack[top++] = u;
+  while(top > 0) {
+    int v = stack[top - 1];
+    while(cur[v] != NULL && g->color[cur[v]->data] != WHITE) {
+      cur[v] = cur[v]->next;
     }
-    moveNext(l);
+    if(cur[v] != NULL) {
+      int w = cur[v]->data;
+      cur[v] = cur[v]->next;
+      g->parent[w] = v;
+      g->discover[w] = ++(*time_stamp);
+      g->color[w] = GRAY;
+      cur[w] = g->adj[w]->head;
+      stack[top++] = w;
+      continue;
+    }
+    top--;
+    g->color[v] = BLACK;
+    g->finish[v] = ++(*time_stamp);
+    if(done != NULL) prepend(done, v);
   }
-  g->color[u] = BLACK;
-  g->finish[u] = ++(*time_stamp);
 }
 
  /* Pre: length(S)==getOrder(G) */
@@ -256,51 +277,50 @@ void DFS(Graph G, List S) {
     fprintf(stderr, "%s error: length(S) != getOrder(G}", __func__);
     exit(1);
   }
-  moveFront(S);
-  while(index(S) >= 0) {
-    int x = get(S);
+  // S is walked node by node, get() would start from the front every time
+  int n = getOrder(G), k = 0;
+  int *order = (int*)malloc(sizeof(int) * (n + 1));
+  for(ListNode *p = S->head; p != NULL; p = p->next) {
+    int x = p->data;
+    order[k++] = x;
     (G->color)[x] = WHITE;
     (G->discover)[x] = UNDEF;
     (G->parent)[x] = NIL;
     (G->finish)[x] = UNDEF;
-    moveNext(S);
   }
-  moveFront(S);
+  // every vertex is in S, so prepending each one as it finishes leaves S
+  // in decreasing finish time, as getSccStack() would
+  clear(S);
+  int *stack = (int*)malloc(sizeof(int) * (n + 1));
+  ListNode **cur = (ListNode**)calloc(1, sizeof(ListNode*) * (n + 1));
   int time_stamp = 0;
-  while(index(S) >= 0) {
-    int x = get(S);
-    if(G->color[x] == WHITE) {
-      visit(G, x, &time_stamp);
+  for(int i = 0; i < k; i++) {
+    if(G->color[order[i]] == WHITE) {
+      visit(G, order[i], &time_stamp, stack, cur, S);
     }
-    moveNext(S);
   }
-  clear(S);
-  List st = getSccStack(G);
-  moveFront(st);
-  while(index(st) >= 0) {
-    int x = get(st);
-    append(S, x);
-    moveNext(st);
-  }
-  freeList(&st);
-  // S = getSccStack(G);
+  free(order);
+  free(stack);
+  free(cur);
 }
 
+// Vertices by decreasing finish time, unfinished ones last in increasing
+// order. Finish times are distinct and at most 2n, so a table indexed by
+// time sorts them.
 List getSccStack(Graph g) {
+  int n = getOrder(g);
+  int *byTime = (int*)calloc(1, sizeof(int) * (2 * n + 1));
   List st = newList();
-  for(int i = 1; i <= getOrder(g); i++) {
-    moveFront(st);
-    while(index(st) >= 0) {
-      int x = get(st);
-      if(g->finish[i] > g->finish[x]) break;
-      moveNext(st);
-    }
-    if(index(st) >= 0) {
-      insertBefore(st, i);
-    } else {
-      append(st, i);
-    }
+  for(int i = 1; i <= n; i++) {
+    if(g->finish[i] >= 1 && g->finish[i] <= 2 * n) byTime[g->finish[i]] = i;
+  }
+  for(int t = 2 * n; t >= 1; t--) {
+    if(byTime[t] != 0) append(st, byTime[t]);
+  }
+  for(int i = 1; i <= n; i++) {
+    if(g->finish[i] < 1 || g->finish[i] > 2 * n) append(st, i);
   }
+  free(byTime);
   return st;
 }
 
@@ -327,7 +347,121 @@ Graph copyGraph(Graph G) {
   return g;
 }
 
+// Pearce's PEA_FIND_SCC2 without recursion. rindex holds the DFS index of
+// a vertex while it is open and its component label (n - 1 downward) once
+// done; indices are given back as components close, so the two ranges never
+// meet. cur keeps each open vertex's place in its adjacency list.
+int SCC(Graph G) {
+  int n = G->order, index = 1, c = n - 1, top = 0, sp = 0;
+  int *rindex = (int*)calloc(1, sizeof(int) * (n + 1));
+  char *root = (char*)calloc(1, n + 1);
+  ListNode **cur = (ListNode**)calloc(1, sizeof(ListNode*) * (n + 1));
+  int *call = (int*)malloc(sizeof(int) * (n + 1));  // open vertices
+  int *stack = (int*)malloc(sizeof(int) * (n + 1)); // done, component open
+  for(int s = 1; s <= n; s++) {
+    if(rindex[s] != 0) continue;
+    rindex[s] = index++;
+    root[s] = 1;
+    cur[s] = G->adj[s]->head;
+    call[top++] = s;
+    while(top > 0) {
+      int v = call[top - 1];
+      if(cur[v] != NULL) {
+        int w = cur[v]->data;
+        if(rindex[w] == 0) {
+          rindex[w] = index++;
+          root[w] = 1;
+          cur[w] = G->adj[w]->head;
+          call[top++] = w;
+          continue;
+        }
+        if(rindex[w] < rindex[v]) {
+          rindex[v] = rindex[w];
+          root[v] = 0;
+        }
+        cur[v] = cur[v]->next;
+        continue;
+      }
+      // v is finished
+      top--;
+      if(root[v]) {
+        index--;
+        while(sp > 0 && rindex[v] <= rindex[stack[sp - 1]]) {
+          rindex[stack[--sp]] = c;
+          index--;
+        }
+        rindex[v] = c--;
+      } else {
+        stack[sp++] = v;
+      }
+      if(top > 0) {
+        int p = call[top - 1];
+        if(rindex[v] < rindex[p]) {
+          rindex[p] = rindex[v];
+          root[p] = 0;
+        }
+        cur[p] = cur[p]->next;
+      }
+    }
+  }
+  // components closed sinks first, so the last label is component 1
+  for(int v = 1; v <= n; v++) {
+    rindex[v] -= c;
+  }
+  free(G->component);
+  G->component = rindex;
+  G->sccCount = n - 1 - c;
+  free(root);
+  free(cur);
+  free(call);
+  free(stack);
+  return G->sccCount;
+}
+
+int getComponent(Graph G, int u) {
+  if(u > G->order || u < 1) {
+    fprintf(stderr, "%s error: u must meet 1 <= u <= getOrder(G) ", __func__);
+    exit(1);
+  }
+  if(G->component == NULL) {
+    fprintf(stderr, "%s error: call SCC first\n", __func__);
+    exit(1);
+  }
+  return G->component[u];
+}
+
+// printGraphSCC after SCC(): members in increasing order, by a counting sort
+// on the labels.
+static void printComponents(FILE *out, Graph g) {
+  int n = g->order, k = g->sccCount;
+  int *start = (int*)calloc(1, sizeof(int) * (k + 2));
+  int *member = (int*)malloc(sizeof(int) * (n + 1));
+  for(int v = 1; v <= n; v++) {
+    start[g->component[v] + 1]++;
+  }
+  for(int i = 1; i <= k + 1; i++) {
+    start[i] += start[i - 1];
+  }
+  for(int v = 1; v <= n; v++) {
+    member[start[g->component[v]]++] = v;
+  }
+  fprintf(out, "G contains %d strongly connected components:\n", k);
+  for(int i = 1, j = 0; i <= k; i++) {
+    fprintf(out, "Component %d:", i);
+    for(; j < start[i]; j++) {
+      fprintf(out, " %d", member[j]);
+    }
+    fprintf(out, "\n");
+  }
+  free(start);
+  free(member);
+}
+
 void printGraphSCC(FILE *out, Graph g) {
+  if(g->component != NULL) {
+    printComponents(out, g);
+    return;
+  }
   
   List st = getSccStack(g);
   moveFront(st);
@@ -24,6 +24,8 @@ typedef struct GraphObj {
   int *discover;     // find time
   int *finish;       // leave time
   u_int32_t timestamp;
+  int *component;    // after SCC(): component of every vertex, numbered in
+  int sccCount;      // topological order; NULL once the edges change
 }GraphObj;
 
 typedef GraphObj* Graph;
@@ -49,12 +51,19 @@ void printGraph(FILE* out, Graph G);
 // pa3
 int getDiscover(Graph G, int u);
 int getFinish(Graph G, int u); 
-void visit(Graph g, int u, int *time_stamp);
 void DFS(Graph G, List S); /* Pre: length(S)==getOrder(G) */
 Graph transpose(Graph G);
 Graph copyGraph(Graph G);
 List getSccStack(Graph g);
 void printGraph(FILE* out , Graph G);
-void printGraphSCC(FILE *out, Graph G);
+void printGraphSCC(FILE *out, Graph G); // After SCC(G): the components of G.
+ // Otherwise G is the transpose after the second Kosaraju DFS and its DFS
+ // trees are printed.
+int SCC(Graph G); // Labels the strongly connected components of G in one
+ // DFS (Pearce's space-efficient Tarjan: one int per vertex, no transpose)
+ // and returns how many there are. Component 1 has no arcs coming in from
+ // the others, each later one only from earlier ones.
+int getComponent(Graph G, int u); // Pre: SCC(G) ran after the last edge
+ // was added
 
 void logG(Graph g);
\ No newline at end of file
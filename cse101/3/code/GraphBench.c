@@ -0,0 +1,148 @@
+//-----------------------------------------------------------------------------
+// GraphBench.c
+// BFS/DFS/SCC benchmark over generated digraphs, see make bench. For every
+// graph family prints the time to build the graph with addArc, the time per
+// run, millions of traversed arcs per second (arcs out of the vertices the
+// search reached; kosaraju counts both DFS passes and the transpose), the bytes
+// in the adjacency lists and the process' peak RSS so far.
+//-----------------------------------------------------------------------------
+#include "Graph.h"
+#include "GraphGen.h"
+#include "List.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+
+static double now(void) {
+  struct timespec ts;
+  timespec_get(&ts, TIME_UTC);
+  return ts.tv_sec * 1e3 + ts.tv_nsec * 1e-6;
+}
+
+static double peakMB(void) {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss / 1024.0;
+}
+
+static double graphMB(Graph G) {
+  double bytes = sizeof(ListObj) * (getOrder(G) + 1.0);
+  bytes += sizeof(ListNode) * (double)getSize(G);
+  return bytes / (1 << 20);
+}
+
+static void header(void) {
+  printf("%-9s %-8s %9s %10s %9s %9s %9s %9s %9s\n", "graph", "engine", "n", "arcs",
+         "load ms", "ms/run", "MTEPS", "graphMB", "peakMB");
+}
+
+static void report(const char *graph, const char *engine, Graph G, double load,
+                   double ms, int runs, double arcs) {
+  printf("%-9s %-8s %9d %10d %9.1f %9.2f %9.3f %9.1f %9.1f\n", graph, engine, getOrder(G),
+         getSize(G), load, ms / runs, arcs / ms / 1e3, graphMB(G), peakMB());
+}
+
+static List allVertices(Graph G) {
+  List S = newList();
+  for(int i = 1; i <= getOrder(G); i++) {
+    append(S, i);
+  }
+  return S;
+}
+
+static void bench(int kind, int scale, int degree, int k, unsigned long long seed) {
+  const char *name = kindName(kind);
+  double t0 = now();
+  EdgeList E = genGraph(kind, scale, degree, seed);
+  double gen = now() - t0;
+  int n = E->order;
+  printf("# %s: %d vertices, %d arcs, generated in %.1f ms\n", name, n, E->size, gen);
+
+  t0 = now();
+  Graph G = newGraph(n);
+  for(int i = 0; i < E->size; i++) {
+    addArc(G, E->U[i], E->V[i]);
+  }
+  double load = now() - t0;
+
+  srand((unsigned)seed);
+  double ms = 0, arcs = 0;
+  for(int i = 0; i < k; i++) {
+    int s = 1 + rand() % n;
+    t0 = now();
+    BFS(G, s);
+    ms += now() - t0;
+    for(int v = 1; v <= n; v++) {
+      if(getDist(G, v) >= 0) arcs += length(G->adj[v]);
+    }
+  }
+  report(name, "bfs", G, load, ms, k, arcs);
+
+  ms = 0;
+  for(int i = 0; i < k; i++) {
+    List S = allVertices(G);
+    t0 = now();
+    DFS(G, S);
+    ms += now() - t0;
+    freeList(&S);
+  }
+  report(name, "dfs", G, 0, ms, k, (double)k * getSize(G));
+
+  // FindComponents: DFS, transpose, DFS in decreasing finish time
+  ms = 0;
+  for(int i = 0; i < k; i++) {
+    List S = allVertices(G);
+    t0 = now();
+    DFS(G, S);
+    Graph T = transpose(G);
+    DFS(T, S);
+    ms += now() - t0;
+    freeGraph(&T);
+    freeList(&S);
+  }
+  report(name, "kosaraju", G, 0, ms, k, 3.0 * k * getSize(G));
+
+  ms = 0;
+  for(int i = 0; i < k; i++) {
+    t0 = now();
+    SCC(G);
+    ms += now() - t0;
+  }
+  report(name, "pearce", G, 0, ms, k, (double)k * getSize(G));
+
+  freeGraph(&G);
+  freeEdgeList(&E);
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: GraphBench [-g rmat|er|grid|powerlaw] [-s scale] [-d degree] [-k runs] [-r seed]\n");
+  exit(1);
+}
+
+int main(int argc, char **argv) {
+  int kind = -1, scale = 10, degree = 8, k = 4;
+  unsigned long long seed = 1;
+  for(int i = 1; i < argc; i += 2) {
+    if(i + 1 >= argc) usage();
+    if(strcmp(argv[i], "-g") == 0) {
+      if((kind = kindByName(argv[i + 1])) < 0) usage();
+    } else if(strcmp(argv[i], "-s") == 0) {
+      scale = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-d") == 0) {
+      degree = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-k") == 0) {
+      k = atoi(argv[i + 1]);
+    } else if(strcmp(argv[i], "-r") == 0) {
+      seed = strtoull(argv[i + 1], NULL, 10);
+    } else {
+      usage();
+    }
+  }
+  if(k < 1) usage();
+  header();
+  for(int g = GEN_RMAT; g <= GEN_POWERLAW; g++) {
+    if(kind < 0 || kind == g) bench(g, scale, degree, k, seed);
+  }
+}
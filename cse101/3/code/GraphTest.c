@@ -27,6 +27,9 @@ int main() {
   for(int i = 1; i<= 4;i++) append(list, i);
   DFS(g, list);
 
+  printGraphSCC(stdout, g);
+  int k = SCC(g);
+  printf("%d %d %d\n", k, getComponent(g, 1), getComponent(g, 4));
   printGraphSCC(stdout, g);
   getPath(path, g, 4);
   printList(stdout, path);
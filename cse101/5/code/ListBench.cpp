@@ -0,0 +1,191 @@
+//-----------------------------------------------------------------------------
+// ListBench.cpp
+// Micro-benchmarks for the List ADT. Prints ns/op and heap allocations per
+// op for each case and size, from 10^3 up to 10^7 elements (or argv[1]).
+//-----------------------------------------------------------------------------
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "List.h"
+
+using namespace std;
+
+// Every operator new in the program goes through here, so allocations made
+// inside List.cpp are counted too.
+static long long allocs = 0;
+
+void* operator new(size_t size) {
+  allocs++;
+  void* p = malloc(size ? size : 1);
+  if (p == nullptr) throw bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// every case runs at least this many operations per size
+static const int MIN_OPS = 1000000;
+
+static volatile long long sink;
+
+static double now() {
+  return chrono::duration<double, nano>(
+             chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+static void report(const char* name, int n, long long ops, double ns,
+                   long long a) {
+  printf("%-10s %9d %12.2f %10.3f\n", name, n, ns / ops, (double)a / ops);
+}
+
+static void build(List& L, int n) {
+  L.moveBack();
+  for (int i = 0; i < n; i++) {
+    L.insertBefore(i);
+  }
+}
+
+static void seek(List& L, int k) {
+  L.moveFront();
+  while (k-- > 0) {
+    L.moveNext();
+  }
+}
+
+static void benchAppend(int n, int reps) {
+  double ns = 0;
+  long long a = 0;
+  for (int r = 0; r < reps; r++) {
+    List L;
+    long long a0 = allocs;
+    double t0 = now();
+    build(L, n);
+    ns += now() - t0;
+    a += allocs - a0;
+  }
+  report("append", n, (long long)n * reps, ns, a);
+}
+
+static void benchPrepend(int n, int reps) {
+  double ns = 0;
+  long long a = 0;
+  for (int r = 0; r < reps; r++) {
+    List L;
+    long long a0 = allocs;
+    double t0 = now();
+    for (int i = 0; i < n; i++) {
+      L.insertAfter(i);
+    }
+    ns += now() - t0;
+    a += allocs - a0;
+  }
+  report("prepend", n, (long long)n * reps, ns, a);
+}
+
+static void benchTraverse(int n, int reps) {
+  List L;
+  build(L, n);
+  long long sum = 0;
+  double t0 = now();
+  for (int r = 0; r < reps; r++) {
+    L.moveFront();
+    while (L.position() < L.length()) {
+      sum += L.moveNext();
+    }
+  }
+  double ns = now() - t0;
+  sink = sum;
+  report("traverse", n, (long long)n * reps, ns, 0);
+}
+
+static void benchInsertMid(int n, int reps) {
+  double ns = 0;
+  long long a = 0;
+  for (int r = 0; r < reps; r++) {
+    List L;
+    build(L, n);
+    seek(L, n / 2);
+    long long a0 = allocs;
+    double t0 = now();
+    for (int i = 0; i < n; i++) {
+      L.insertBefore(i);
+    }
+    ns += now() - t0;
+    a += allocs - a0;
+  }
+  report("insertmid", n, (long long)n * reps, ns, a);
+}
+
+static void benchDeleteMid(int n, int reps) {
+  int ops = n / 2;
+  double ns = 0;
+  for (int r = 0; r < reps; r++) {
+    List L;
+    build(L, n);
+    seek(L, n / 4);
+    double t0 = now();
+    for (int i = 0; i < ops; i++) {
+      L.eraseAfter();
+    }
+    ns += now() - t0;
+  }
+  report("deletemid", n, (long long)ops * reps, ns, 0);
+}
+
+static void benchCopy(int n, int reps) {
+  List L;
+  build(L, n);
+  double ns = 0;
+  long long a = 0;
+  for (int r = 0; r < reps; r++) {
+    long long a0 = allocs;
+    double t0 = now();
+    List C(L);
+    ns += now() - t0;
+    a += allocs - a0;
+    sink = C.length();
+  }
+  report("copy", n, (long long)n * reps, ns, a);
+}
+
+static void benchConcat(int n, int reps) {
+  List A, B;
+  build(A, n / 2);
+  build(B, n - n / 2);
+  double ns = 0;
+  long long a = 0;
+  for (int r = 0; r < reps; r++) {
+    long long a0 = allocs;
+    double t0 = now();
+    List C = A.concat(B);
+    ns += now() - t0;
+    a += allocs - a0;
+    sink = C.length();
+  }
+  report("concat", n, (long long)n * reps, ns, a);
+}
+
+int main(int argc, char** argv) {
+  int maxN = 10000000;
+  if (argc > 2 || (argc == 2 && (maxN = atoi(argv[1])) < 1000)) {
+    fprintf(stderr, "usage: %s [max n >= 1000]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+  printf("%-10s %9s %12s %10s\n", "case", "n", "ns/op", "allocs/op");
+  for (int n = 1000; n <= maxN; n *= 10) {
+    int reps = (n < MIN_OPS) ? MIN_OPS / n : 1;
+    benchAppend(n, reps);
+    benchPrepend(n, reps);
+    benchTraverse(n, reps);
+    benchInsertMid(n, reps);
+    benchDeleteMid(n, reps);
+    benchCopy(n, reps);
+    benchConcat(n, reps);
+  }
+  return EXIT_SUCCESS;
+}